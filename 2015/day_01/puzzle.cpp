@@ -7,35 +7,155 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
 #include "myutils.h"
 
 using namespace std;
 
+// Santa's floor over a stream of brackets, fed in chunks of any size.
+//
+// The input is cut in 64-byte blocks. Each block is turned into +1/-1/0
+// bytes and summed with vector operations. While the basement has not been
+// entered and the floor is low enough for the block to reach -1, the
+// block's prefix sums are also computed in vector registers (6 shift-and-
+// add steps); only the block whose minimum prefix reaches -1 is scanned
+// byte by byte.
+class floor_counter
+{
+    static constexpr int BLOCK = 64;
+    typedef signed char bytes __attribute__((vector_size(BLOCK)));
+
+    long long floor_ = 0;
+    long long position_ = 0;
+    long long firstBasement_ = -1;
+
+    // The vectors are passed by reference: by value, their ABI depends on
+    // the instruction set enabled (-Wpsabi).
+
+    // Add the lanes moved up by K, zeros shifted in (indices >= BLOCK select
+    // the second operand of __builtin_shuffle, all zeros)
+    template <int K, size_t... I>
+    static void add_shifted_up(bytes& v, index_sequence<I...>)
+    {
+        constexpr bytes mask = { (signed char)(I >= K ? I - K : BLOCK)... };
+        v += __builtin_shuffle(v, bytes{}, mask);
+    }
+
+    template <int K>
+    static void add_shifted_up(bytes& v)
+    {
+        add_shifted_up<K>(v, make_index_sequence<BLOCK>());
+    }
+
+    static int sum(const bytes& v)
+    {
+        int s = 0;
+        for(int i=0; i<BLOCK; i++)
+            s += v[i];
+        return s;
+    }
+
+    static int minimum(const bytes& v)
+    {
+        signed char m = v[0];
+        for(int i=1; i<BLOCK; i++)
+            m = min(m, v[i]);
+        return m;
+    }
+
+    void block(const char* p)
+    {
+        bytes c;
+        memcpy(&c, p, BLOCK);
+
+        // '(' up, ')' down, anything else (padding) stays
+        bytes d = (c == ')') - (c == '(');
+
+        // A block moves by 64 floors at most
+        if(firstBasement_ >= 0 || floor_ >= BLOCK)
+        {
+            floor_ += sum(d);
+            position_ += BLOCK;
+            return;
+        }
+
+        // Inclusive prefix sums
+        bytes prefix = d;
+        add_shifted_up<1>(prefix);
+        add_shifted_up<2>(prefix);
+        add_shifted_up<4>(prefix);
+        add_shifted_up<8>(prefix);
+        add_shifted_up<16>(prefix);
+        add_shifted_up<32>(prefix);
+
+        if(floor_ + minimum(prefix) <= -1)
+        {
+            for(int i=0; i<BLOCK; i++)
+            {
+                if(floor_ + prefix[i] == -1)
+                {
+                    firstBasement_ = position_ + i + 1;
+                    break;
+                }
+            }
+        }
+
+        floor_ += prefix[BLOCK - 1];
+        position_ += BLOCK;
+    }
+
+public:
+
+    void feed(string_view chunk)
+    {
+        size_t i = 0;
+        for(; i + BLOCK <= chunk.size(); i += BLOCK)
+            block(chunk.data() + i);
+
+        // Last partial block, padded with neutral bytes
+        if(i < chunk.size())
+        {
+            char last[BLOCK] = {};
+            memcpy(last, chunk.data() + i, chunk.size() - i);
+            block(last);
+            position_ -= BLOCK - (chunk.size() - i);
+        }
+    }
+
+    long long floor() const { return floor_; }
+
+    // 1-based position of the first character entering the basement, -1 if none
+    long long first_basement() const { return firstBasement_; }
+};
+
 // Solve puzzle #1
 template <typename T>
-constexpr int solve_puzzle1(T data)
+long long solve_puzzle1(T data)
 {
-    return count(data.begin(), data.end(), '(') - count(data.begin(), data.end(), ')') ;
+    floor_counter counter;
+    counter.feed(data);
+    return counter.floor();
 }
 
 // Solve puzzle #2
 template <typename T>
-constexpr int solve_puzzle2(T data)
+long long solve_puzzle2(T data)
 {
-    int position = 0;
-    int sum = 0;
-
-    for(char d : data)
-    {
-        sum = sum + (d == '(' ? 1 : -1);
-        position++;
-
-        if(sum == -1)
-            break;
-    }
+    floor_counter counter;
+    counter.feed(data);
+    return counter.first_basement();
+}
 
-    // cout << "Position: " << position << endl;
-    return position;
+// Solve both puzzles in a single pass over the instructions
+template <typename T>
+vector<long long> solve_puzzles(const T& data)
+{
+    floor_counter counter;
+    counter.feed(data);
+    return { counter.floor(), counter.first_basement() };
 }
 
 int main(int argc, char *argv[])
@@ -58,22 +178,26 @@ int main(int argc, char *argv[])
     // Reading the data
     auto data = myutils::read_file<string, std::vector<string> >(filename);
 
-#if 0
-    for(auto d : data[0])
-        cout << d;
-    cout << endl;
-#endif
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    assert(solve_puzzle1(data[0]) == 138 && "Error verifying puzzle #1");
-
-    // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data[0]) << std::endl;
+    assert(solve_puzzle1(string("(())")) == 0 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(string("))(((((")) == 3 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(string(")())())")) == -3 && "Error verifying puzzle #1");
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
-    assert(solve_puzzle2(data[0]) == 1771 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(string(")")) == 1 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(string("()())")) == 5 && "Error verifying puzzle #2");
+
+    // Both puzzles in one pass
+    auto answers = solve_puzzles(data[0]);
+    assert(answers[0] == 138 && "Error verifying puzzle #1");
+    assert(answers[1] == 1771 && "Error verifying puzzle #2");
 
+    // Solve puzzle #1
+    std::cout << "Answer for puzzle #1: "<< answers[0] << std::endl;
+
+    // --------- Puzzle #2 ---------
     // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data[0]) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< answers[1] << std::endl;
 }
@@ -7,92 +7,175 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+#include <thread>
 #include "myutils.h"
-#include <sstream>      // std::istringstream
 
 using namespace std;
 
-struct box
+// Both answers for a list of boxes, 64-bit: large manifests overflow int
+struct manifest_totals
 {
-    int x;
-    int y;
-    int z;
+    long long paper = 0;
+    long long ribbon = 0;
 
-    const int surface() const
+    manifest_totals& operator+=(const manifest_totals& rhs)
     {
-        return 2*x*y + 2*y*z + 2*x*z;
+        paper += rhs.paper;
+        ribbon += rhs.ribbon;
+        return *this;
     }
+};
 
-    const int minSideSurface() const
-    {
-        return std::min(std::min(x*y, y*z), x*z);
-    }
+inline void add_box(manifest_totals& totals, long long x, long long y, long long z)
+{
+    // a <= b <= c
+    long long a = min(min(x, y), z);
+    long long c = max(max(x, y), z);
+    long long b = x + y + z - a - c;
 
-    const int maxSidePerimeter() const
-    {
-        return std::max(std::max(x, y), z);
-    }
+    totals.paper  += 2*(a*b + b*c + a*c) + a*b;
+    totals.ribbon += 2*(a + b) + a*b*c;
+}
 
-    const int totalSidePerimeter() const
-    {
-        return 2*x + 2*y + 2*z;
-    }
+// Hand-rolled scanner for "LxWxH" records, one per line. Records without
+// exactly 3 dimensions are skipped.
+manifest_totals scan_records(string_view text)
+{
+    manifest_totals totals;
 
-    const int volume() const
+    long long dims[3];
+    int nbrDims = 0;
+    long long value = 0;
+    bool inNumber = false;
+
+    for(char c : text)
     {
-        return x*y*z;
+        if(c >= '0' && c <= '9')
+        {
+            value = value * 10 + (c - '0');
+            inNumber = true;
+            continue;
+        }
+
+        if(inNumber)
+        {
+            if(nbrDims < 3)
+                dims[nbrDims] = value;
+            nbrDims++;
+            value = 0;
+            inNumber = false;
+        }
+
+        if(c != 'x')
+        {
+            // End of record
+            if(nbrDims == 3)
+                add_box(totals, dims[0], dims[1], dims[2]);
+            nbrDims = 0;
+        }
     }
-};
 
-std::ostream& operator<<(std::ostream& os, const box& b)
-{
-    return os << b.x << "x" << b.y << "x" << b.z << " : " << b.surface() << " : "  << b.minSideSurface();
-}
+    if(inNumber && nbrDims == 2)
+        add_box(totals, dims[0], dims[1], value);
 
+    return totals;
+}
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data)
+// Same, the text cut in one chunk per thread at line boundaries
+manifest_totals scan_records_parallel(string_view text, int nbrThreads)
 {
-    int totalArea = 0;
-    for(string d : data)
-    {
-        std::istringstream iss (d);
+    vector<string_view> chunks;
 
-        box b;
-        char sep;
+    size_t begin = 0;
+    for(int t=0; t<nbrThreads && begin<text.size(); t++)
+    {
+        size_t end = (t == nbrThreads - 1) ? text.size() : begin + (text.size() - begin) / (nbrThreads - t);
 
-        iss >> b.x >> sep >> b.y >> sep >> b.z;
+        end = text.find('\n', end);
+        end = (end == string_view::npos) ? text.size() : end + 1;
 
-        // cout << b << endl;
-        totalArea += b.surface() + b.minSideSurface();
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
     }
 
-    return totalArea;
+    vector<manifest_totals> partial(chunks.size());
+    vector<thread> threads;
+
+    for(size_t t=1; t<chunks.size(); t++)
+        threads.emplace_back([&, t]() { partial[t] = scan_records(chunks[t]); });
+
+    if(!chunks.empty())
+        partial[0] = scan_records(chunks[0]);
+
+    for(auto& th : threads)
+        th.join();
+
+    manifest_totals totals;
+    for(auto& p : partial)
+        totals += p;
+
+    return totals;
 }
 
-// Solve puzzle #2
-template <typename T>
-int solve_puzzle2(T data)
+// Whole manifest file in one pass: read in large blocks, each block
+// scanned in parallel, the partial last line carried to the next block.
+manifest_totals scan_file(const string& filename)
 {
-    int totalLength = 0;
-    for(string d : data)
+    const size_t BLOCK_SIZE = 16 << 20;
+    const int nbrThreads = max(1u, thread::hardware_concurrency());
+
+    ifstream file(filename, ios::binary);
+
+    manifest_totals totals;
+    string buffer;
+    size_t carried = 0;
+
+    while(file)
     {
-        std::istringstream iss (d);
+        buffer.resize(carried + BLOCK_SIZE);
+        file.read(&buffer[carried], BLOCK_SIZE);
+        size_t size = carried + file.gcount();
+
+        // Up to the last full line, unless this is the end of the file
+        size_t end = size;
+        if(file)
+        {
+            size_t lastNewline = string_view(buffer.data(), size).rfind('\n');
+            end = (lastNewline == string_view::npos) ? 0 : lastNewline + 1;
+        }
+
+        totals += scan_records_parallel(string_view(buffer.data(), end), nbrThreads);
+
+        carried = size - end;
+        buffer.erase(0, end);
+    }
 
-        box b;
-        char sep;
+    return totals;
+}
 
-        iss >> b.x >> sep >> b.y >> sep >> b.z;
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    manifest_totals totals;
+    for(auto& d : data)
+        totals += scan_records(d);
 
-        // cout << b << endl;
+    return totals.paper;
+}
 
-        totalLength += b.totalSidePerimeter()
-            - 2*b.maxSidePerimeter()
-            + b.volume();
-    }
+// Solve puzzle #2
+template <typename T>
+long long solve_puzzle2(T data)
+{
+    manifest_totals totals;
+    for(auto& d : data)
+        totals += scan_records(d);
 
-    return totalLength;
+    return totals.ribbon;
 }
 
 int main(int argc, char *argv[])
@@ -112,27 +195,24 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    // Reading the data
-    auto data = myutils::read_file<string, std::vector<string> >(filename);
-
-#if 0
-    for(string d : data)
-        cout << d << endl;
-    cout << endl;
-#endif
+    // Reading the data: both answers in one pass over the file
+    manifest_totals totals = scan_file(filename);
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    const auto example1 = 1;
-    assert(solve_puzzle1(data) == 1588178 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"2x3x4"}) == 58 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"1x1x10"}) == 43 && "Error verifying puzzle #1");
+    assert(totals.paper == 1588178 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
+    std::cout << "Answer for puzzle #1: "<< totals.paper << std::endl;
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
-    assert(solve_puzzle2(data) == 3783758 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"2x3x4"}) == 34 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"1x1x10"}) == 14 && "Error verifying puzzle #2");
+    assert(totals.ribbon == 3783758 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< totals.ribbon << std::endl;
 }
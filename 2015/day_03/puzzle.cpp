@@ -7,8 +7,11 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
-#include <map>
-#include <valarray>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string_view>
+#include <thread>
 #include "myutils.h"
 
 using namespace std;
@@ -31,116 +34,265 @@ std::ostream& operator<<(std::ostream& os, const houseCoord& h)
     return os << h.x << ":" << h.y;
 }
 
-void
-computePath(valarray<char> path, map<string, int>& visitedHouses)
+// Move of each character, a table lookup instead of a branch per move
+struct moveTable
 {
-    houseCoord curHouse({0, 0});
-    string key = "00";
-    visitedHouses[key]++;
+    houseCoord moves[256];
 
-    for(auto p : path)
+    moveTable()
     {
-        switch(p)
+        for(auto& m : moves)
+            m = {0, 0};
+
+        moves[(unsigned char)'^'] = {0, 1};
+        moves[(unsigned char)'v'] = {0, -1};
+        moves[(unsigned char)'>'] = {1, 0};
+        moves[(unsigned char)'<'] = {-1, 0};
+    }
+};
+
+inline houseCoord move_of(char c)
+{
+    static const moveTable table;
+    return table.moves[(unsigned char)c];
+}
+
+// Both coordinates in one exact 64-bit key
+inline uint64_t pack(const houseCoord& h)
+{
+    return (uint64_t(uint32_t(h.x)) << 32) | uint32_t(h.y);
+}
+
+// Set of coordinates: open addressing, linear probing, 64-bit keys.
+// (INT_MIN, INT_MIN) marks the empty slots, a walk never gets there.
+class coord_set
+{
+    static constexpr uint64_t EMPTY = (uint64_t(uint32_t(INT_MIN)) << 32) | uint32_t(INT_MIN);
+
+    vector<uint64_t> slots_;
+    size_t size_;
+    int shift_;
+
+    size_t slot_of(uint64_t key) const
+    {
+        return (key * 0x9e3779b97f4a7c15ULL) >> shift_;
+    }
+
+    void grow()
+    {
+        vector<uint64_t> old(2 * slots_.size(), EMPTY);
+        old.swap(slots_);
+        shift_--;
+        size_ = 0;
+
+        for(auto key : old)
+            if(key != EMPTY)
+                insert_key(key);
+    }
+
+public:
+
+    coord_set()
+        : slots_(1024, EMPTY),
+          size_(0),
+          shift_(64 - 10)
+    {}
+
+    // True if new
+    bool insert_key(uint64_t key)
+    {
+        // Load factor below 1/2
+        if(2 * (size_ + 1) > slots_.size())
+            grow();
+
+        const size_t mask = slots_.size() - 1;
+        for(size_t i = slot_of(key); ; i = (i + 1) & mask)
         {
-            case '^':
-            {
-                curHouse += {0, 1};
-            }
-            break;
-            case 'v':
-            {
-                curHouse += {0, -1};
-            }
-            break;
-            case '>':
-            {
-                curHouse += {1, 0};
-            }
-            break;
-            case '<':
+            if(slots_[i] == key)
+                return false;
+
+            if(slots_[i] == EMPTY)
             {
-                curHouse += {-1, 0};
+                slots_[i] = key;
+                size_++;
+                return true;
             }
-            break;
         }
-        key = to_string(curHouse.x) + to_string(curHouse.y);
+    }
 
-        visitedHouses[key]++;
+    bool insert(const houseCoord& h)
+    {
+        return insert_key(pack(h));
     }
 
-}
+    void merge(const coord_set& other)
+    {
+        for(auto key : other.slots_)
+            if(key != EMPTY)
+                insert_key(key);
+    }
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data)
+    size_t size() const { return size_; }
+};
+
+// Bounding box of the houses visited by one walker
+struct bounds
 {
-    houseCoord curHouse({0, 0});
-    map<string, int> visitedHouses;
+    int minX = 0;
+    int maxX = 0;
+    int minY = 0;
+    int maxY = 0;
 
-    string key = "00";
+    void add(const houseCoord& h)
+    {
+        minX = min(minX, h.x);
+        maxX = max(maxX, h.x);
+        minY = min(minY, h.y);
+        maxY = max(maxY, h.y);
+    }
 
-    visitedHouses[key]++;
+    void add(const bounds& b)
+    {
+        add(houseCoord{b.minX, b.minY});
+        add(houseCoord{b.maxX, b.maxY});
+    }
 
-    for(auto d : data)
+    long long area() const
     {
-        switch(d)
-        {
-            case '^':
-                curHouse += {0, 1};
-                break;
-            case 'v':
-                curHouse += {0, -1};
-                break;
-            case '>':
-                curHouse += {1, 0};
-                break;
-            case '<':
-                curHouse += {-1, 0};
-                break;
-        }
+        return (long long)(maxX - minX + 1) * (maxY - minY + 1);
+    }
+};
 
-        key = to_string(curHouse.x) + to_string(curHouse.y);
+// Walker w of nbrWalkers takes the moves w, w+nbrWalkers, ...
+template <typename F>
+void walk(string_view moves, int w, int nbrWalkers, F visit)
+{
+    houseCoord h = {0, 0};
+    visit(h);
 
-        visitedHouses[key]++;
+    for(size_t i=w; i<moves.size(); i+=nbrWalkers)
+    {
+        h += move_of(moves[i]);
+        visit(h);
     }
+}
 
-    return visitedHouses.size();
+// Threads used for nbrWalkers walkers: at most one per hardware thread
+inline int nbr_threads(int nbrWalkers)
+{
+    int nbrCores = max(1u, thread::hardware_concurrency());
+    return max(1, min(nbrWalkers, nbrCores));
 }
 
-// Solve puzzle #2
-template <typename T>
-int solve_puzzle2(T data)
+// Run f(w, t) for every walker w: thread t of nbrThreads takes a contiguous
+// chunk of the walkers, one after the other
+template <typename F>
+void for_each_walker(int nbrWalkers, int nbrThreads, F f)
 {
-    valarray<char> fullPath(data.size());
-    for(int i=0; i<data.size(); i++)
-        fullPath[i] = data[i];
+    auto chunk = [&](int t)
+    {
+        int first = (long long)nbrWalkers * t / nbrThreads;
+        int last = (long long)nbrWalkers * (t + 1) / nbrThreads;
+        for(int w=first; w<last; w++)
+            f(w, t);
+    };
+
+    vector<thread> threads;
+    for(int t=1; t<nbrThreads; t++)
+        threads.emplace_back(chunk, t);
+
+    chunk(0);
+
+    for(auto& t : threads)
+        t.join();
+}
+
+// Houses visited at least once by nbrWalkers walkers taking turns.
+//
+// A first pass measures the bounding box. If it is small enough, every
+// thread marks its own bitmap of the box, and the bitmaps are OR-ed; if not,
+// every thread fills its own coord_set, and the sets are merged.
+long long visited_houses(string_view moves, int nbrWalkers)
+{
+    // Bitmaps up to 16 MB per thread
+    const long long MAX_BITMAP_CELLS = 1LL << 27;
+
+    const int nbrThreads = nbr_threads(nbrWalkers);
+
+    vector<bounds> threadBounds(nbrThreads);
+    for_each_walker(nbrWalkers, nbrThreads, [&](int w, int t)
+    {
+        walk(moves, w, nbrWalkers, [&](const houseCoord& h) { threadBounds[t].add(h); });
+    });
 
-    // use valarray and slice with strides to extract Santa and Robot paths
-    valarray<char> santaPath = fullPath[std::slice(0,data.size()/2, 2)];
-    valarray<char> robotPath = fullPath[std::slice(1,data.size()/2, 2)];
+    bounds box;
+    for(auto& b : threadBounds)
+        box.add(b);
 
-#if 0
-    cout << "size of fullPath:" << fullPath.size() << endl;
-    cout << "size of santaPath:" << santaPath.size() << endl;
-    cout << "size of robotPath:" << robotPath.size() << endl;
+    if(box.area() <= MAX_BITMAP_CELLS)
+    {
+        const long long width = box.maxX - box.minX + 1;
+        const size_t nbrWords = (box.area() + 63) / 64;
 
-    cout << "santaPath: " << endl;
-    for(auto p : santaPath)
-        cout << p;
-    cout << endl;
+        vector<vector<uint64_t>> bitmaps(nbrThreads);
+        for_each_walker(nbrWalkers, nbrThreads, [&](int w, int t)
+        {
+            vector<uint64_t>& bits = bitmaps[t];
+            if(bits.empty())
+                bits.assign(nbrWords, 0);
 
-    cout << "robotPath: " << endl;
-    for(auto p : robotPath)
-        cout << p;
-    cout << endl;
-#endif
+            walk(moves, w, nbrWalkers, [&](const houseCoord& h)
+            {
+                long long cell = (h.y - box.minY) * width + (h.x - box.minX);
+                bits[cell / 64] |= uint64_t(1) << (cell % 64);
+            });
+        });
 
-    map<string, int> visitedHouses;
+        long long count = 0;
+        for(size_t i=0; i<nbrWords; i++)
+        {
+            uint64_t word = 0;
+            for(auto& bits : bitmaps)
+                word |= bits[i];
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
 
-    computePath(santaPath, visitedHouses);
-    computePath(robotPath, visitedHouses);
+    vector<coord_set> sets(nbrThreads);
+    for_each_walker(nbrWalkers, nbrThreads, [&](int w, int t)
+    {
+        walk(moves, w, nbrWalkers, [&](const houseCoord& h) { sets[t].insert(h); });
+    });
+
+    for(int t=1; t<nbrThreads; t++)
+        sets[0].merge(sets[t]);
 
-    return visitedHouses.size();
+    return sets[0].size();
+}
+
+// Same, always with the hash sets
+long long visited_houses_hashed(string_view moves, int nbrWalkers)
+{
+    coord_set visited;
+    for(int w=0; w<nbrWalkers; w++)
+        walk(moves, w, nbrWalkers, [&](const houseCoord& h) { visited.insert(h); });
+
+    return visited.size();
+}
+
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    return visited_houses(data, 1);
+}
+
+// Solve puzzle #2: Santa and Robo-Santa
+template <typename T>
+long long solve_puzzle2(T data)
+{
+    return visited_houses(data, 2);
 }
 
 int main(int argc, char *argv[])
@@ -165,6 +317,10 @@ int main(int argc, char *argv[])
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
+    assert(solve_puzzle1(string(">")) == 2 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(string("^>v<")) == 4 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(string("^v^v^v^v^v")) == 2 && "Error verifying puzzle #1");
+    assert(visited_houses_hashed(data[0], 1) == solve_puzzle1(data[0]) && "Error verifying puzzle #1");
     assert(solve_puzzle1(data[0]) == 2592 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
@@ -172,6 +328,10 @@ int main(int argc, char *argv[])
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
+    assert(solve_puzzle2(string("^v")) == 3 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(string("^>v<")) == 3 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(string("^v^v^v^v^v")) == 11 && "Error verifying puzzle #2");
+    assert(visited_houses_hashed(data[0], 2) == solve_puzzle2(data[0]) && "Error verifying puzzle #2");
     assert(solve_puzzle2(data[0]) == 2360 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
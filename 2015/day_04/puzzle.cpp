@@ -8,83 +8,42 @@
 #include <cassert>
 #include <vector>
 #include "myutils.h"
-
-#include <stdio.h>
-#include <string.h>
-#include <openssl/md5.h>
+#include "myhashsearch.h"
+#include "myhashsearch_openssl.h"
 
 using namespace std;
 
+using myutils::hashsearch::predicate;
+
+// Smallest nonce such that MD5(key + nonce) starts with 'difficulty' zeros.
+// The in-tree lane-parallel MD5 by default.
+template <typename Backend = myutils::hashsearch::md5_simd>
+long long mine(const string& key, int difficulty)
+{
+    return myutils::hashsearch::searcher<Backend>(key).find_first(predicate::leading_zeros(difficulty));
+}
+
 // Solve puzzle #1
 template <typename T>
-int solve_puzzle1(T data)
+long long solve_puzzle1(T data)
 {
-    unsigned char md[MD5_DIGEST_LENGTH];
-    bool found = false;
-    long counter = 0;
-    while(!found)
-    {
-        string newKey = data + std::to_string(counter++);
-
-        MD5
-        (
-            (const unsigned char*)(newKey.c_str()),
-            newKey.size(),
-            md
-        );
-
-        // NB: hex is 4 bits...
-        if(md[0] == 0 && md[1] == 0 && md[2] <= 16)
-        {
-            cout << "Found hash: " << newKey << " : " ;
-
-            for(int i=0; i <MD5_DIGEST_LENGTH; i++)
-            {
-                printf("%02x",md[i]);
-            }
-            cout << " : Counter: "  << --counter << endl;
-
-            found = true;
-        }
-    }
-
-    return counter;
+    return mine(data, 5);
 }
 
 // Solve puzzle #2
 template <typename T>
-constexpr int solve_puzzle2(T data)
+long long solve_puzzle2(T data)
 {
-    unsigned char md[MD5_DIGEST_LENGTH];
-    bool found = false;
-    long counter = 0;
-    while(!found)
-    {
-        string newKey = data + std::to_string(counter++);
-
-        MD5
-        (
-            (const unsigned char*)(newKey.c_str()),
-            newKey.size(),
-            md
-        );
-
-        // NB: hex is 4 bits...
-        if(md[0] == 0 && md[1] == 0 && md[2] == 0)
-        {
-            cout << "Found hash: " << newKey << " : " ;
-
-            for(int i=0; i <MD5_DIGEST_LENGTH; i++)
-            {
-                printf("%02x",md[i]);
-            }
-            cout << " : Counter: "  << --counter << endl;
-
-            found = true;
-        }
-    }
+    return mine(data, 6);
+}
+
+// Solve both puzzles in a single pass over the nonces
+template <typename T>
+vector<long long> solve_puzzles(T data)
+{
+    myutils::hashsearch::searcher<myutils::hashsearch::md5_simd> search(data);
 
-    return counter;
+    return search.find_first({ predicate::leading_zeros(5), predicate::leading_zeros(6) });
 }
 
 int main(int argc, char *argv[])
@@ -107,17 +66,22 @@ int main(int argc, char *argv[])
     // Reading the data
     auto data = myutils::read_file<string, std::vector<string> >(filename);
 
-    cout << data[0] << endl;
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
+    assert(myutils::md5::to_hex(myutils::md5::hash("abcdef609043")).compare(0, 11, "000001dbbfa") == 0 && "Error verifying MD5");
     assert(solve_puzzle1(string("abcdef")) == 609043 && "Error verifying puzzle #1");
     assert(solve_puzzle1(string("pqrstuv")) == 1048970 && "Error verifying puzzle #1");
-    solve_puzzle1(data[0]);
+
+    // The OpenSSL MD5 backend must agree
+    assert(mine<myutils::hashsearch::openssl_md5>("abcdef", 5) == 609043 && "Error verifying OpenSSL MD5 backend");
+
+    // Both puzzles in one pass
+    auto answers = solve_puzzles(data[0]);
 
     // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data[0]) << std::endl;
+    std::cout << "Answer for puzzle #1: "<< answers[0] << std::endl;
 
     // --------- Puzzle #2 ---------
     // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data[0]) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< answers[1] << std::endl;
 }
@@ -7,102 +7,177 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
-#include <sstream>      // std::stringstream
+#include <algorithm>
+#include <cstring>
+#include <string_view>
 #include "myutils.h"
 
 using namespace std;
 
-// Solve puzzle #1
-template <typename T>
-constexpr int solve_puzzle1(T data)
+// Rules satisfied by a string
+enum : unsigned
 {
-    const vector vowels = {'a', 'e', 'i', 'o', 'u'};
-
-    int nbrNiceString = 0;
-
-    for(auto d : data)
-    {
-        //cout << d << endl;
+    NICE_1 = 1,     // 3 vowels, a doubled letter, none of ab cd pq xy
+    NICE_2 = 2      // a pair twice without overlap, a letter repeated with one between
+};
 
-        int numVowels = 0;
-        for (const char target: {'a', 'e', 'i', 'o', 'u'})
-        {
-            numVowels += std::count(d.cbegin(), d.cend(), target);
-        }
-        // cout << "Number vowels: " << numVowels << '\n';
+// Classify a string against all the rules of both puzzles in one scan.
+//
+// The byte rules (vowels, doubled letters, forbidden pairs, repeats with
+// a letter between) compare 32 positions at a time: the string at offsets
+// 0, 1 and 2 side by side in vector registers. The repeated pair rule
+// keeps the first position of each of the 26x26 letter pairs in a table,
+// stamped per string so it is never cleared.
+class nice_classifier
+{
+    static constexpr int LANES = 32;
+    typedef signed char bytes __attribute__((vector_size(LANES)));
 
-        bool hasDoubleSeq = false;
+    unsigned stamp_[26 * 26] = {};
+    int firstPos_[26 * 26];
+    unsigned current_ = 0;
 
-        auto e = end(d), i = std::adjacent_find(begin(d), e);
+    // The vectors are passed by reference: by value, their ABI depends on
+    // the instruction set enabled (-Wpsabi).
 
-        if(i != e)
-        {
-            hasDoubleSeq = true;
-        }
-        // cout << "Has doubled letters: " << d << " : "  << hasDoubleSeq << endl;
+    static void load(bytes& v, const char* p)
+    {
+        memcpy(&v, p, sizeof(v));
+    }
 
-        int numSpecialTokens = 0;
-        for (const string target: {"ab" , "cd", "pq" , "xy"})
-        {
-            numSpecialTokens += (d.find(target) != string::npos);
-        }
-        //cout << "Number special tokens: " << numSpecialTokens << endl;
-
-        // Is this string nice?
-        if(
-            numVowels >=3 &&
-            hasDoubleSeq &&
-            numSpecialTokens == 0
-        )
-        {
-            nbrNiceString++;
-        }
+    // Number of true lanes of a comparison
+    static int count(const bytes& m)
+    {
+        int n = 0;
+        for(int i=0; i<LANES; i++)
+            n -= m[i];
+        return n;
     }
-    return nbrNiceString;
-}
 
-// Solve puzzle #2
-template <typename T>
-constexpr int solve_puzzle2(T data)
-{
-    int nbrNiceString = 0;
+    // Mask of the lanes 0..n-1
+    static void first_lanes(bytes& mask, int n)
+    {
+        bytes lane;
+        for(int i=0; i<LANES; i++)
+            lane[i] = i;
+        mask = lane < (bytes{} + (signed char)max(0, min(n, LANES)));
+    }
 
-    for(auto d : data)
+    bool has_repeated_pair(string_view s)
     {
-        // Find non-overlapping pairs
-        bool hasNonOverlappingPairs = false;
-        for (int i=0; i<d.size()-1; i++)
+        current_++;
+
+        for(int i=0; i+1<(int)s.size(); i++)
         {
-            std::string subS = d.substr (i,2);
+            unsigned a = s[i] - 'a';
+            unsigned b = s[i + 1] - 'a';
+            if(a >= 26 || b >= 26)
+                continue;
 
-            if(d.find(subS, i+2) !=std::string::npos)
+            unsigned pair = a * 26 + b;
+
+            if(stamp_[pair] != current_)
             {
-                hasNonOverlappingPairs = true;
-                break;
+                stamp_[pair] = current_;
+                firstPos_[pair] = i;
             }
-        }
-
-        // Find repeats with one letter between
-        bool hasRepatedLetters = false;
-        for (int i=0; i<d.size()-2; i++)
-        {
-            if(d[i] == d[i+2])
+            else if(firstPos_[pair] + 2 <= i)
             {
-                hasRepatedLetters = true;
-                break;
+                return true;
             }
         }
+        return false;
+    }
+
+public:
 
-        // Is this a nice string?
-        if(hasNonOverlappingPairs && hasRepatedLetters)
+    unsigned classify(string_view s)
+    {
+        const int length = s.size();
+
+        int vowels = 0;
+        bool doubled = false;
+        bool forbidden = false;
+        bool repeatWithGap = false;
+
+        // Chunk, plus the 2 next bytes, zero-padded
+        char buffer[LANES + 2 + LANES];
+
+        for(int start=0; start<length; start+=LANES)
         {
-            nbrNiceString++;
+            int n = min(length - start, LANES + 2);
+            memcpy(buffer, s.data() + start, n);
+            memset(buffer + n, 0, sizeof(buffer) - n);
+
+            bytes c0, c1, c2;
+            load(c0, buffer);
+            load(c1, buffer + 1);
+            load(c2, buffer + 2);
+
+            bytes in0, in1, in2;
+            first_lanes(in0, length - start);
+            first_lanes(in1, length - start - 1);
+            first_lanes(in2, length - start - 2);
+
+            bytes isVowel = (c0 == 'a') | (c0 == 'e') | (c0 == 'i') | (c0 == 'o') | (c0 == 'u');
+            bytes startsBad = (c0 == 'a') | (c0 == 'c') | (c0 == 'p') | (c0 == 'x');
+
+            vowels        += count(isVowel & in0);
+            doubled       |= count((c0 == c1) & in1) > 0;
+            forbidden     |= count(startsBad & (c1 == c0 + 1) & in1) > 0;
+            repeatWithGap |= count((c0 == c2) & in2) > 0;
         }
+
+        unsigned rules = 0;
+
+        if(vowels >= 3 && doubled && !forbidden)
+            rules |= NICE_1;
+
+        if(repeatWithGap && has_repeated_pair(s))
+            rules |= NICE_2;
+
+        return rules;
     }
+};
 
+// Number of strings satisfying the rules of puzzle #1 and of puzzle #2,
+// from a single classification of each string
+template <typename T>
+vector<int> count_nice(const T& data)
+{
+    nice_classifier classifier;
+
+    vector<int> nbrNiceString(2, 0);
+    for(auto& d : data)
+    {
+        unsigned rules = classifier.classify(d);
+        nbrNiceString[0] += (rules & NICE_1) != 0;
+        nbrNiceString[1] += (rules & NICE_2) != 0;
+    }
     return nbrNiceString;
 }
 
+// Solve puzzle #1
+template <typename T>
+int solve_puzzle1(const T& data)
+{
+    return count_nice(data)[0];
+}
+
+// Solve puzzle #2
+template <typename T>
+int solve_puzzle2(const T& data)
+{
+    return count_nice(data)[1];
+}
+
+// Solve both puzzles in a single pass over the strings
+template <typename T>
+vector<int> solve_puzzles(const T& data)
+{
+    return count_nice(data);
+}
+
 int main(int argc, char *argv[])
 {
     // Need a command-line parameter for the input filename
@@ -135,9 +210,6 @@ int main(int argc, char *argv[])
     };
     assert(solve_puzzle1<vector<string>>(example1) == 2 && "Error verifying puzzle #1");
 
-    // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
-
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
     const std::vector<std::string> example2 = {
@@ -149,6 +221,12 @@ int main(int argc, char *argv[])
 
     assert(solve_puzzle2<vector<string>>(example2) == 2 && "Error verifying puzzle #2");
 
+    // Both puzzles in one pass
+    auto answers = solve_puzzles(data);
+
+    // Solve puzzle #1
+    std::cout << "Answer for puzzle #1: "<< answers[0] << std::endl;
+
     // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< answers[1] << std::endl;
 }
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
 #include <sstream>      // std::stringstream
 #include "myutils.h"
 
@@ -23,7 +25,7 @@ class Instruction
 {
 public:
     Command command;   // Command
-    myutils::point c1; // Corner points
+    myutils::point c1; // Corner points, inclusive
     myutils::point c2;
 
     // Default constructor
@@ -37,28 +39,26 @@ public:
         c2      = b.c2;
     };
 
+    Instruction& operator=(const Instruction &b) = default;
 };
 
-// Solve puzzle #1
 template <typename T>
-constexpr int solve_puzzle1(T data)
+vector<Instruction> parse_instructions(const T& data)
 {
-    vector<Instruction> instructions(0);
+    vector<Instruction> instructions;
+    instructions.reserve(data.size());
 
-    for(auto d : data)
+    for(auto& d : data)
     {
         Instruction instr;
 
-        cout << d << endl;
-
-        size_t last_index = d.find_first_of("0123456789");
-        string result = d.substr(last_index - 1);
-        cout << result << endl;
+        size_t first_digit = d.find_first_of("0123456789");
+        if(first_digit == string::npos)
+            continue;
 
-        myutils::point c1, c2;  // Corner points
         string c_scrap;
         char sep;
-        std::stringstream ss(d.substr(last_index - 1));
+        std::stringstream ss(d.substr(first_digit));
         ss >> instr.c1.x >> sep >> instr.c1.y
             >> c_scrap
             >> instr.c2.x >> sep >> instr.c2.y;
@@ -77,21 +77,238 @@ constexpr int solve_puzzle1(T data)
         }
         else
         {
-            cout << " Error: bad command : "  << d << endl;
+            cerr << " Error: bad command : "  << d << endl;
+            continue;
         }
 
         instructions.push_back(instr);
     }
 
-    bool grid[1000][1000];
-    return 42;
+    return instructions;
+}
+
+// Bit-packed field of lights, one bit per light, 64 lights per word.
+// A rectangle operation is a run of whole words per row, plus a masked
+// word at each end: the inner loops are plain word loops the compiler
+// vectorizes (AVX2 with -march=native).
+class light_grid
+{
+    int width_;
+    int height_;
+    int wordsPerRow_;
+    vector<uint64_t> bits_;
+
+public:
+
+    light_grid(int width, int height)
+        : width_(width),
+          height_(height),
+          wordsPerRow_((width + 63) / 64),
+          bits_(size_t(wordsPerRow_) * height, 0)
+    {}
+
+    void apply(const Instruction& instr)
+    {
+        const int w1 = instr.c1.x / 64;
+        const int w2 = instr.c2.x / 64;
+
+        // Bits c1.x%64.. of the first word, ..c2.x%64 of the last one
+        const uint64_t firstMask = ~uint64_t(0) << (instr.c1.x % 64);
+        const uint64_t lastMask  = ~uint64_t(0) >> (63 - instr.c2.x % 64);
+
+        for(int y=instr.c1.y; y<=instr.c2.y; y++)
+        {
+            uint64_t* row = bits_.data() + size_t(y) * wordsPerRow_;
+
+            for(int w=w1; w<=w2; w++)
+            {
+                uint64_t mask = ~uint64_t(0);
+                if(w == w1)
+                    mask &= firstMask;
+                if(w == w2)
+                    mask &= lastMask;
+
+                switch(instr.command)
+                {
+                case ON:     row[w] |= mask;  break;
+                case OFF:    row[w] &= ~mask; break;
+                case TOGGLE: row[w] ^= mask;  break;
+                }
+            }
+        }
+    }
+
+    long long count() const
+    {
+        long long n = 0;
+        for(auto word : bits_)
+            n += __builtin_popcountll(word);
+        return n;
+    }
+};
+
+// Effect of a sequence of instructions on one light, lit or not:
+// f(b) = (b & keep) ^ flip
+struct switch_fn
+{
+    int keep;
+    int flip;
+
+    static switch_fn identity() { return {1, 0}; }
+
+    static switch_fn of(Command c)
+    {
+        switch(c)
+        {
+        case ON:  return {0, 1};
+        case OFF: return {0, 0};
+        default:  return {1, 1};
+        }
+    }
+
+    // this, then next
+    switch_fn then(const switch_fn& next) const
+    {
+        return { keep & next.keep, (flip & next.keep) ^ next.flip };
+    }
+
+    long long value() const { return flip; }
+};
+
+// Effect of a sequence of instructions on the brightness of one light:
+// f(b) = max(b + add, floor). Turning off clamps at 0, so this is not a
+// plain sum, but the composition of two such functions is one again.
+struct brightness_fn
+{
+    long long add;
+    long long floor;
+
+    static brightness_fn identity() { return {0, 0}; }
+
+    static brightness_fn of(Command c)
+    {
+        switch(c)
+        {
+        case ON:  return {1, 0};
+        case OFF: return {-1, 0};
+        default:  return {2, 0};
+        }
+    }
+
+    brightness_fn then(const brightness_fn& next) const
+    {
+        return { add + next.add, max(floor + next.add, next.floor) };
+    }
+
+    // Starting from 0
+    long long value() const { return max(add, floor); }
+};
+
+// Sum of F(0) over all the lights, without any field of lights.
+//
+// The rectangle edges cut the plane in strips of columns where every
+// light sees the same instructions. For each strip, a sweep in y keeps
+// the instructions covering the current rows in a segment tree indexed by
+// instruction order: its root is the composition of all of them, in
+// order. Memory is O(instructions), time O(instructions x strips x log).
+template <typename F>
+long long sweep_total(const vector<Instruction>& instructions)
+{
+    const int n = instructions.size();
+
+    // Column strip boundaries
+    vector<int> xs;
+    for(auto& instr : instructions)
+    {
+        xs.push_back(instr.c1.x);
+        xs.push_back(instr.c2.x + 1);
+    }
+    sort(xs.begin(), xs.end());
+    xs.erase(unique(xs.begin(), xs.end()), xs.end());
+
+    // Row events, sorted once: instruction i starts at c1.y, ends at c2.y+1
+    struct event
+    {
+        int y;
+        int index;
+        bool start;
+    };
+
+    vector<event> events;
+    for(int i=0; i<n; i++)
+    {
+        events.push_back({instructions[i].c1.y, i, true});
+        events.push_back({instructions[i].c2.y + 1, i, false});
+    }
+    sort(events.begin(), events.end(), [](const event& a, const event& b) { return a.y < b.y; });
+
+    int leaves = 1;
+    while(leaves < n)
+        leaves *= 2;
+
+    vector<F> tree(2 * leaves);
+
+    long long total = 0;
+
+    for(size_t s=0; s+1<xs.size(); s++)
+    {
+        const int x0 = xs[s];
+        const long long stripWidth = xs[s + 1] - x0;
+
+        fill(tree.begin(), tree.end(), F::identity());
+
+        for(size_t e=0; e<events.size(); )
+        {
+            const int y = events[e].y;
+
+            // All the events of row y
+            for(; e<events.size() && events[e].y == y; e++)
+            {
+                const Instruction& instr = instructions[events[e].index];
+                if(instr.c1.x > x0 || instr.c2.x < x0)
+                    continue;
+
+                int node = leaves + events[e].index;
+                tree[node] = events[e].start ? F::of(instr.command) : F::identity();
+
+                for(node /= 2; node >= 1; node /= 2)
+                    tree[node] = tree[2 * node].then(tree[2 * node + 1]);
+            }
+
+            if(e < events.size())
+                total += tree[1].value() * stripWidth * (events[e].y - y);
+        }
+    }
+
+    return total;
+}
+
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    auto instructions = parse_instructions(data);
+
+    int width = 0;
+    int height = 0;
+    for(auto& instr : instructions)
+    {
+        width  = max(width,  instr.c2.x + 1);
+        height = max(height, instr.c2.y + 1);
+    }
+
+    light_grid grid(width, height);
+    for(auto& instr : instructions)
+        grid.apply(instr);
+
+    return grid.count();
 }
 
 // Solve puzzle #2
 template <typename T>
-constexpr int solve_puzzle2(T data)
+long long solve_puzzle2(T data)
 {
-    return 42;
+    return sweep_total<brightness_fn>(parse_instructions(data));
 }
 
 int main(int argc, char *argv[])
@@ -117,16 +334,27 @@ int main(int argc, char *argv[])
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    //const auto example1 = "1";
-    //assert(solve_puzzle1<vector<string>>({example1}) == 42 && "Error verifying puzzle #1");
+    const vector<string> example1 = {
+        "turn on 0,0 through 999,999",
+        "toggle 0,0 through 999,0",
+        "turn off 499,499 through 500,500"
+    };
+    assert(solve_puzzle1<vector<string>>({example1[0]}) == 1000000 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({example1[0], example1[1]}) == 999000 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(example1) == 998996 && "Error verifying puzzle #1");
+
+    // The sweep must agree with the bit grid
+    assert(sweep_total<switch_fn>(parse_instructions(example1)) == 998996 && "Error verifying puzzle #1 sweep");
+    assert(sweep_total<switch_fn>(parse_instructions(data)) == solve_puzzle1(data) && "Error verifying puzzle #1 sweep");
 
     // Solve puzzle #1
     std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
-    const auto example2 = "2";
-    assert(solve_puzzle2<vector<string>>({example2}) == 42 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"turn on 0,0 through 0,0"}) == 1 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"toggle 0,0 through 999,999"}) == 2000000 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"turn off 0,0 through 9,9", "turn on 0,0 through 1,0"}) == 2 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
     std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;
@@ -0,0 +1,466 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// Search for the smallest nonces n such that hash(key + decimal(n)) matches
+// some predicate on the digest (2015 day 04 and its look-alikes).
+//
+// - predicate: (digest & mask) == value, byte by byte. Built from a number
+//   of leading zero hex digits, from a hex prefix, or from an explicit mask.
+// - backend: the hash function. md5_simd (in-tree, lane-parallel, see
+//   mymd5.h) here, the OpenSSL ones (MD5, SHA-1, SHA-256) in
+//   myhashsearch_openssl.h.
+// - searcher<Backend>: hands out ordered blocks of nonces to the threads.
+//
+//    myutils::hashsearch::searcher<myutils::hashsearch::md5_simd> search(key);
+//    auto first = search.find_first({ predicate::leading_zeros(5),
+//                                     predicate::leading_zeros(6) });
+//
+// Several predicates are tracked in the same pass: every nonce is hashed
+// once, whatever the number of predicates.
+//
+// A backend B provides:
+//   static const int DIGEST_LENGTH;
+//   explicit B(std::string_view key);
+//   // Hash the nonces of [first, last), all with the same number of digits,
+//   // and call hit(n, digest) at least for every digest matching one of the
+//   // predicates, in increasing order of n. Stop and return false as soon
+//   // as hit returns false.
+//   template <typename Hit>
+//   bool scan(long long first, long long last, const std::vector<predicate>& predicates, Hit hit) const;
+
+#ifndef MYHASHSEARCH_H
+#define MYHASHSEARCH_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "mymd5.h"
+
+namespace myutils
+{
+namespace hashsearch
+{
+    static const long long MAX_NONCE = 1000000000000000000LL;
+
+    // Room for any digest, up to SHA-512
+    static const int MAX_DIGEST_LENGTH = 64;
+
+    typedef std::array<unsigned char, MAX_DIGEST_LENGTH> digest_buffer;
+
+    // Decimal nonce as ASCII digits, incremented in place
+    class decimal_counter
+    {
+        char digits_[20];
+        int size_;
+
+    public:
+
+        explicit decimal_counter(long long n)
+        {
+            size_ = 1;
+            for(long long p = 10; p <= n && size_ < 19; p *= 10)
+                size_++;
+
+            for(int i=size_-1; i>=0; i--)
+            {
+                digits_[i] = '0' + n % 10;
+                n /= 10;
+            }
+        }
+
+        // Same number of digits: the caller splits the ranges at powers of 10
+        void next()
+        {
+            for(int i=size_-1; i>=0 && ++digits_[i] > '9'; i--)
+                digits_[i] = '0';
+        }
+
+        const char* data() const { return digits_; }
+        int size() const         { return size_; }
+    };
+
+    // (digest[i] & mask[i]) == value[i] for the first size() bytes
+    class predicate
+    {
+        std::vector<unsigned char> mask_;
+        std::vector<unsigned char> value_;
+
+    public:
+
+        predicate(std::vector<unsigned char> mask, std::vector<unsigned char> value)
+            : mask_(std::move(mask)),
+              value_(std::move(value))
+        {
+            if(mask_.size() != value_.size())
+                throw std::invalid_argument("predicate: mask and value sizes differ");
+
+            for(std::size_t i=0; i<mask_.size(); i++)
+                value_[i] &= mask_[i];
+        }
+
+        // The hex representation starts with hex (ie: "00000")
+        static predicate hex_prefix(std::string_view hex)
+        {
+            std::vector<unsigned char> mask((hex.size() + 1) / 2, 0);
+            std::vector<unsigned char> value(mask.size(), 0);
+
+            for(std::size_t k=0; k<hex.size(); k++)
+            {
+                char c = hex[k];
+                int nibble;
+
+                if(c >= '0' && c <= '9')
+                    nibble = c - '0';
+                else if(c >= 'a' && c <= 'f')
+                    nibble = c - 'a' + 10;
+                else if(c >= 'A' && c <= 'F')
+                    nibble = c - 'A' + 10;
+                else
+                    throw std::invalid_argument("predicate: not a hex digit");
+
+                // Even digits are the high nibble of their byte
+                int shift = (k % 2 == 0) ? 4 : 0;
+                mask[k / 2]  |= 0xf << shift;
+                value[k / 2] |= nibble << shift;
+            }
+
+            return predicate(mask, value);
+        }
+
+        // The hex representation starts with nbrHexDigits zeros
+        static predicate leading_zeros(int nbrHexDigits)
+        {
+            return hex_prefix(std::string(nbrHexDigits, '0'));
+        }
+
+        int size() const                 { return mask_.size(); }
+        unsigned char mask(int i) const  { return mask_[i]; }
+        unsigned char value(int i) const { return value_[i]; }
+
+        bool matches(const unsigned char* md, int length) const
+        {
+            if(size() > length)
+                return false;
+
+            for(int i=0; i<size(); i++)
+            {
+                if((md[i] & mask_[i]) != value_[i])
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    // In-tree MD5, NATIVE_LANES nonces per transform call.
+    // The key's full blocks are hashed once, only the message words holding
+    // the digits are rebuilt for each nonce, and the predicates are first
+    // checked on the state words of all the lanes at once.
+    class md5_simd
+    {
+        static const int N = md5::NATIVE_LANES;
+        typedef md5::lanes<N>::word W;
+
+        std::uint64_t keyLength_;
+
+        // State after the full blocks of the key, and the remaining bytes
+        md5::state<std::uint32_t> midstate_;
+        std::string tail_;
+
+    public:
+
+        static const int DIGEST_LENGTH = md5::DIGEST_LENGTH;
+
+        explicit md5_simd(std::string_view key)
+            : keyLength_(key.size()),
+              midstate_(md5::initial_state())
+        {
+            std::size_t used = md5::absorb(midstate_, key);
+            tail_ = key.substr(used);
+        }
+
+        template <typename Hit>
+        bool scan(long long first, long long last, const std::vector<predicate>& predicates, Hit hit) const
+        {
+            // Predicates as masks and values on the little-endian state words
+            // (bytes past the digest are left to predicate::matches)
+            const int nbrPredicates = predicates.size();
+            std::vector<std::array<W, 4>> masks(nbrPredicates);
+            std::vector<std::array<W, 4>> values(nbrPredicates);
+
+            for(int p=0; p<nbrPredicates; p++)
+            {
+                unsigned char m[DIGEST_LENGTH] = {};
+                unsigned char v[DIGEST_LENGTH] = {};
+
+                for(int i=0; i<predicates[p].size() && i<DIGEST_LENGTH; i++)
+                {
+                    m[i] = predicates[p].mask(i);
+                    v[i] = predicates[p].value(i);
+                }
+
+                for(int w=0; w<4; w++)
+                {
+                    masks[p][w]  = W{} + md5::load_le32(m + 4*w);
+                    values[p][w] = W{} + md5::load_le32(v + 4*w);
+                }
+            }
+
+            decimal_counter counter(first);
+
+            const int nbrDigits = counter.size();
+            const int digitPos  = tail_.size();
+
+            // Final block(s) template, digits zeroed
+            unsigned char blocks[2 * md5::BLOCK_LENGTH];
+            int nbrBlocks = md5::pad(
+                tail_ + std::string(nbrDigits, '0'),
+                keyLength_ + nbrDigits,
+                blocks);
+
+            // A leading block without digits is the same for every nonce
+            md5::state<std::uint32_t> startState = midstate_;
+            int firstBlock = 0;
+
+            if(digitPos >= md5::BLOCK_LENGTH)
+            {
+                std::uint32_t M[16];
+                for(int w=0; w<16; w++)
+                    M[w] = md5::load_le32(blocks + 4*w);
+                md5::transform(startState, M);
+                firstBlock = 1;
+            }
+
+            // Message words, per lane. Only the words holding digits change.
+            W M[2][16];
+            for(int b=firstBlock; b<nbrBlocks; b++)
+                for(int w=0; w<16; w++)
+                    M[b][w] = W{} + md5::load_le32(blocks + b * md5::BLOCK_LENGTH + 4*w);
+
+            const int firstWord = digitPos / 4;
+            const int lastWord  = (digitPos + nbrDigits - 1) / 4;
+
+            const md5::state<W> start = md5::broadcast<N>(startState);
+
+            for(long long n = first; n < last; n += N)
+            {
+                int nbrLanes = std::min<long long>(N, last - n);
+
+                for(int lane=0; lane<N; lane++)
+                {
+                    // Extra lanes of a partial batch: same as the last one
+                    if(lane < nbrLanes)
+                    {
+                        std::memcpy(blocks + digitPos, counter.data(), nbrDigits);
+                        counter.next();
+                    }
+
+                    for(int w=firstWord; w<=lastWord; w++)
+                        M[w / 16][w % 16][lane] = md5::load_le32(blocks + 4*w);
+                }
+
+                md5::state<W> s = start;
+                for(int b=firstBlock; b<nbrBlocks; b++)
+                    md5::transform(s, M[b]);
+
+                W candidate = W{};
+                for(int p=0; p<nbrPredicates; p++)
+                {
+                    W diff = ((s.a & masks[p][0]) ^ values[p][0]) |
+                             ((s.b & masks[p][1]) ^ values[p][1]) |
+                             ((s.c & masks[p][2]) ^ values[p][2]) |
+                             ((s.d & masks[p][3]) ^ values[p][3]);
+                    candidate |= (W)(diff == 0);
+                }
+
+                for(int lane=0; lane<nbrLanes; lane++)
+                {
+                    if(candidate[lane])
+                    {
+                        md5::digest md = md5::to_digest({ s.a[lane], s.b[lane], s.c[lane], s.d[lane] });
+                        if(!hit(n + lane, md.data()))
+                            return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+
+    template <typename Backend>
+    class searcher
+    {
+        Backend backend_;
+        int nbrThreads_;
+        long long blockSize_;
+
+        // Scan [first, last), cut at the changes of number of digits
+        template <typename Hit>
+        bool scan_block(long long first, long long last, const std::vector<predicate>& predicates, Hit hit) const
+        {
+            while(first < last)
+            {
+                long long nextPow10 = 10;
+                while(nextPow10 <= first)
+                    nextPow10 *= 10;
+
+                long long end = std::min(last, nextPow10);
+
+                if(!backend_.scan(first, end, predicates, hit))
+                    return false;
+
+                first = end;
+            }
+            return true;
+        }
+
+        int nbr_threads() const
+        {
+            return nbrThreads_ > 0 ? nbrThreads_ : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+    public:
+
+        // nbrThreads: 0 for all the hardware threads
+        explicit searcher(std::string_view key, int nbrThreads = 0, long long blockSize = 1 << 16)
+            : backend_(key),
+              nbrThreads_(nbrThreads),
+              blockSize_(blockSize)
+        {}
+
+        // Smallest nonce below limit matching each predicate, -1 if none
+        std::vector<long long> find_first(const std::vector<predicate>& predicates, long long limit = MAX_NONCE) const
+        {
+            const int nbrPredicates = predicates.size();
+
+            std::unique_ptr<std::atomic<long long>[]> best(new std::atomic<long long>[nbrPredicates]);
+            for(int p=0; p<nbrPredicates; p++)
+                best[p] = LLONG_MAX;
+
+            // No predicate can still improve at or after n
+            auto done = [&](long long n)
+            {
+                for(int p=0; p<nbrPredicates; p++)
+                {
+                    if(best[p].load() > n)
+                        return false;
+                }
+                return true;
+            };
+
+            std::atomic<long long> nextBlock(0);
+
+            auto worker = [&]()
+            {
+                while(true)
+                {
+                    long long first = nextBlock.fetch_add(1) * blockSize_;
+
+                    if(first >= limit || done(first))
+                        break;
+
+                    scan_block(first, std::min(first + blockSize_, limit), predicates,
+                        [&](long long n, const unsigned char* md)
+                        {
+                            for(int p=0; p<nbrPredicates; p++)
+                            {
+                                if(predicates[p].matches(md, Backend::DIGEST_LENGTH))
+                                {
+                                    long long current = best[p].load();
+                                    while(n < current && !best[p].compare_exchange_weak(current, n))
+                                        ;
+                                }
+                            }
+                            return !done(n);
+                        });
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for(int t=1; t<nbr_threads(); t++)
+                threads.emplace_back(worker);
+
+            worker();
+
+            for(auto& t : threads)
+                t.join();
+
+            std::vector<long long> result(nbrPredicates);
+            for(int p=0; p<nbrPredicates; p++)
+                result[p] = best[p].load() == LLONG_MAX ? -1 : best[p].load();
+
+            return result;
+        }
+
+        long long find_first(const predicate& p, long long limit = MAX_NONCE) const
+        {
+            return find_first(std::vector<predicate>{ p }, limit)[0];
+        }
+
+        // Stream the matches of p below limit in increasing order of nonce:
+        // f(n, digest) is called until it returns false.
+        // The blocks are scanned by waves of nbr_threads() blocks, the
+        // matches of a wave are reported once the whole wave is done.
+        template <typename F>
+        void for_each_match(const predicate& p, F f, long long limit = MAX_NONCE) const
+        {
+            const std::vector<predicate> predicates = { p };
+            const int nbrThreads = nbr_threads();
+
+            typedef std::pair<long long, digest_buffer> match;
+            std::vector<std::vector<match>> matches(nbrThreads);
+
+            for(long long waveStart = 0; waveStart < limit; waveStart += nbrThreads * blockSize_)
+            {
+                auto worker = [&](int t)
+                {
+                    long long first = waveStart + t * blockSize_;
+
+                    matches[t].clear();
+                    if(first >= limit)
+                        return;
+
+                    scan_block(first, std::min(first + blockSize_, limit), predicates,
+                        [&](long long n, const unsigned char* md)
+                        {
+                            if(p.matches(md, Backend::DIGEST_LENGTH))
+                            {
+                                matches[t].emplace_back(n, digest_buffer());
+                                std::memcpy(matches[t].back().second.data(), md, Backend::DIGEST_LENGTH);
+                            }
+                            return true;
+                        });
+                };
+
+                std::vector<std::thread> threads;
+                for(int t=1; t<nbrThreads; t++)
+                    threads.emplace_back(worker, t);
+
+                worker(0);
+
+                for(auto& t : threads)
+                    t.join();
+
+                for(auto& blockMatches : matches)
+                    for(auto& m : blockMatches)
+                        if(!f(m.first, m.second.data()))
+                            return;
+            }
+        }
+    };
+}
+}
+
+#endif  // MYHASHSEARCH_H
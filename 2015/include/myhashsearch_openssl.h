@@ -0,0 +1,95 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// OpenSSL backends for myhashsearch.h: MD5, SHA-1 and SHA-256 through the
+// EVP interface. One nonce at a time; the context holding the key is hashed
+// once and copied for every nonce.
+//
+// Link with -lcrypto.
+
+#ifndef MYHASHSEARCH_OPENSSL_H
+#define MYHASHSEARCH_OPENSSL_H
+
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <openssl/evp.h>
+#include "myhashsearch.h"
+
+namespace myutils
+{
+namespace hashsearch
+{
+    template <const EVP_MD* (*Algorithm)(), int Length>
+    class evp_backend
+    {
+        // Context after the key
+        EVP_MD_CTX* keyContext_;
+
+    public:
+
+        static const int DIGEST_LENGTH = Length;
+
+        explicit evp_backend(std::string_view key)
+            : keyContext_(EVP_MD_CTX_new())
+        {
+            if(keyContext_ == nullptr ||
+               !EVP_DigestInit_ex(keyContext_, Algorithm(), nullptr) ||
+               !EVP_DigestUpdate(keyContext_, key.data(), key.size()))
+            {
+                EVP_MD_CTX_free(keyContext_);
+                throw std::runtime_error("evp_backend: cannot initialize the digest");
+            }
+        }
+
+        ~evp_backend()
+        {
+            EVP_MD_CTX_free(keyContext_);
+        }
+
+        evp_backend(const evp_backend&) = delete;
+        evp_backend& operator=(const evp_backend&) = delete;
+
+        template <typename Hit>
+        bool scan(long long first, long long last, const std::vector<predicate>& predicates, Hit hit) const
+        {
+            EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+            unsigned char md[EVP_MAX_MD_SIZE];
+            unsigned int length;
+
+            decimal_counter counter(first);
+            bool keepGoing = true;
+
+            for(long long n = first; n < last && keepGoing; n++)
+            {
+                EVP_MD_CTX_copy_ex(ctx, keyContext_);
+                EVP_DigestUpdate(ctx, counter.data(), counter.size());
+                EVP_DigestFinal_ex(ctx, md, &length);
+                counter.next();
+
+                for(auto& p : predicates)
+                {
+                    if(p.matches(md, Length))
+                    {
+                        keepGoing = hit(n, md);
+                        break;
+                    }
+                }
+            }
+
+            EVP_MD_CTX_free(ctx);
+
+            return keepGoing;
+        }
+    };
+
+    typedef evp_backend<EVP_md5,    16> openssl_md5;
+    typedef evp_backend<EVP_sha1,   20> openssl_sha1;
+    typedef evp_backend<EVP_sha256, 32> openssl_sha256;
+}
+}
+
+#endif  // MYHASHSEARCH_OPENSSL_H
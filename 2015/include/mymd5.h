@@ -0,0 +1,291 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// In-tree MD5, scalar and lane-parallel.
+//
+// The block transform is written once for any "word" type: uint32_t, or a
+// GCC vector of N uint32_t lanes. With N lanes, N independent messages are
+// hashed by a single call; the compiler maps the vector operations onto
+// SSE2 (4 lanes), AVX2 (8 lanes) or AVX-512 (16 lanes) depending on the
+// target (-march=native in the Release build). NATIVE_LANES is the widest
+// size the target has registers for.
+//
+// The state after any number of full 64-byte blocks can be kept
+// (midstate), so a constant message prefix is only hashed once.
+
+#ifndef MYMD5_H
+#define MYMD5_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace myutils
+{
+namespace md5
+{
+    static const int DIGEST_LENGTH = 16;
+    static const int BLOCK_LENGTH  = 64;
+
+    typedef std::array<unsigned char, DIGEST_LENGTH> digest;
+
+    // Lane-parallel word: N messages side by side
+    template <int N>
+    struct lanes
+    {
+        typedef std::uint32_t word __attribute__((vector_size(4 * N)));
+    };
+
+    template <>
+    struct lanes<1>
+    {
+        typedef std::uint32_t word;
+    };
+
+#if defined(__AVX512F__)
+    static const int NATIVE_LANES = 16;
+#elif defined(__AVX2__)
+    static const int NATIVE_LANES = 8;
+#else
+    static const int NATIVE_LANES = 4;
+#endif
+
+    // Chaining state
+    template <typename W>
+    struct state
+    {
+        W a;
+        W b;
+        W c;
+        W d;
+    };
+
+    inline state<std::uint32_t> initial_state()
+    {
+        return { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    }
+
+    // Same state in every lane
+    template <int N>
+    inline state<typename lanes<N>::word> broadcast(const state<std::uint32_t>& s)
+    {
+        typedef typename lanes<N>::word W;
+        return { W{} + s.a, W{} + s.b, W{} + s.c, W{} + s.d };
+    }
+
+    namespace detail
+    {
+        static const std::uint32_t K[64] =
+        {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+            0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+            0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+            0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+            0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+        };
+
+        template <typename W>
+        inline W rotl(W x, int s)
+        {
+            return (x << s) | (x >> (32 - s));
+        }
+    }
+
+#define AOC_MD5_STEP(f, a, b, c, d, i, k, s) \
+    a = b + detail::rotl(a + (f) + detail::K[i] + M[k], s)
+
+#define AOC_MD5_F(b, c, d) (d ^ (b & (c ^ d)))
+#define AOC_MD5_G(b, c, d) (c ^ (d & (b ^ c)))
+#define AOC_MD5_H(b, c, d) (b ^ c ^ d)
+#define AOC_MD5_I(b, c, d) (c ^ (b | ~d))
+
+    // One 64-byte block: M holds the 16 little-endian message words
+    template <typename W>
+    inline void transform(state<W>& s, const W* M)
+    {
+        W a = s.a, b = s.b, c = s.c, d = s.d;
+
+        AOC_MD5_STEP(AOC_MD5_F(b,c,d), a, b, c, d,  0,  0,  7);
+        AOC_MD5_STEP(AOC_MD5_F(a,b,c), d, a, b, c,  1,  1, 12);
+        AOC_MD5_STEP(AOC_MD5_F(d,a,b), c, d, a, b,  2,  2, 17);
+        AOC_MD5_STEP(AOC_MD5_F(c,d,a), b, c, d, a,  3,  3, 22);
+        AOC_MD5_STEP(AOC_MD5_F(b,c,d), a, b, c, d,  4,  4,  7);
+        AOC_MD5_STEP(AOC_MD5_F(a,b,c), d, a, b, c,  5,  5, 12);
+        AOC_MD5_STEP(AOC_MD5_F(d,a,b), c, d, a, b,  6,  6, 17);
+        AOC_MD5_STEP(AOC_MD5_F(c,d,a), b, c, d, a,  7,  7, 22);
+        AOC_MD5_STEP(AOC_MD5_F(b,c,d), a, b, c, d,  8,  8,  7);
+        AOC_MD5_STEP(AOC_MD5_F(a,b,c), d, a, b, c,  9,  9, 12);
+        AOC_MD5_STEP(AOC_MD5_F(d,a,b), c, d, a, b, 10, 10, 17);
+        AOC_MD5_STEP(AOC_MD5_F(c,d,a), b, c, d, a, 11, 11, 22);
+        AOC_MD5_STEP(AOC_MD5_F(b,c,d), a, b, c, d, 12, 12,  7);
+        AOC_MD5_STEP(AOC_MD5_F(a,b,c), d, a, b, c, 13, 13, 12);
+        AOC_MD5_STEP(AOC_MD5_F(d,a,b), c, d, a, b, 14, 14, 17);
+        AOC_MD5_STEP(AOC_MD5_F(c,d,a), b, c, d, a, 15, 15, 22);
+
+        AOC_MD5_STEP(AOC_MD5_G(b,c,d), a, b, c, d, 16,  1,  5);
+        AOC_MD5_STEP(AOC_MD5_G(a,b,c), d, a, b, c, 17,  6,  9);
+        AOC_MD5_STEP(AOC_MD5_G(d,a,b), c, d, a, b, 18, 11, 14);
+        AOC_MD5_STEP(AOC_MD5_G(c,d,a), b, c, d, a, 19,  0, 20);
+        AOC_MD5_STEP(AOC_MD5_G(b,c,d), a, b, c, d, 20,  5,  5);
+        AOC_MD5_STEP(AOC_MD5_G(a,b,c), d, a, b, c, 21, 10,  9);
+        AOC_MD5_STEP(AOC_MD5_G(d,a,b), c, d, a, b, 22, 15, 14);
+        AOC_MD5_STEP(AOC_MD5_G(c,d,a), b, c, d, a, 23,  4, 20);
+        AOC_MD5_STEP(AOC_MD5_G(b,c,d), a, b, c, d, 24,  9,  5);
+        AOC_MD5_STEP(AOC_MD5_G(a,b,c), d, a, b, c, 25, 14,  9);
+        AOC_MD5_STEP(AOC_MD5_G(d,a,b), c, d, a, b, 26,  3, 14);
+        AOC_MD5_STEP(AOC_MD5_G(c,d,a), b, c, d, a, 27,  8, 20);
+        AOC_MD5_STEP(AOC_MD5_G(b,c,d), a, b, c, d, 28, 13,  5);
+        AOC_MD5_STEP(AOC_MD5_G(a,b,c), d, a, b, c, 29,  2,  9);
+        AOC_MD5_STEP(AOC_MD5_G(d,a,b), c, d, a, b, 30,  7, 14);
+        AOC_MD5_STEP(AOC_MD5_G(c,d,a), b, c, d, a, 31, 12, 20);
+
+        AOC_MD5_STEP(AOC_MD5_H(b,c,d), a, b, c, d, 32,  5,  4);
+        AOC_MD5_STEP(AOC_MD5_H(a,b,c), d, a, b, c, 33,  8, 11);
+        AOC_MD5_STEP(AOC_MD5_H(d,a,b), c, d, a, b, 34, 11, 16);
+        AOC_MD5_STEP(AOC_MD5_H(c,d,a), b, c, d, a, 35, 14, 23);
+        AOC_MD5_STEP(AOC_MD5_H(b,c,d), a, b, c, d, 36,  1,  4);
+        AOC_MD5_STEP(AOC_MD5_H(a,b,c), d, a, b, c, 37,  4, 11);
+        AOC_MD5_STEP(AOC_MD5_H(d,a,b), c, d, a, b, 38,  7, 16);
+        AOC_MD5_STEP(AOC_MD5_H(c,d,a), b, c, d, a, 39, 10, 23);
+        AOC_MD5_STEP(AOC_MD5_H(b,c,d), a, b, c, d, 40, 13,  4);
+        AOC_MD5_STEP(AOC_MD5_H(a,b,c), d, a, b, c, 41,  0, 11);
+        AOC_MD5_STEP(AOC_MD5_H(d,a,b), c, d, a, b, 42,  3, 16);
+        AOC_MD5_STEP(AOC_MD5_H(c,d,a), b, c, d, a, 43,  6, 23);
+        AOC_MD5_STEP(AOC_MD5_H(b,c,d), a, b, c, d, 44,  9,  4);
+        AOC_MD5_STEP(AOC_MD5_H(a,b,c), d, a, b, c, 45, 12, 11);
+        AOC_MD5_STEP(AOC_MD5_H(d,a,b), c, d, a, b, 46, 15, 16);
+        AOC_MD5_STEP(AOC_MD5_H(c,d,a), b, c, d, a, 47,  2, 23);
+
+        AOC_MD5_STEP(AOC_MD5_I(b,c,d), a, b, c, d, 48,  0,  6);
+        AOC_MD5_STEP(AOC_MD5_I(a,b,c), d, a, b, c, 49,  7, 10);
+        AOC_MD5_STEP(AOC_MD5_I(d,a,b), c, d, a, b, 50, 14, 15);
+        AOC_MD5_STEP(AOC_MD5_I(c,d,a), b, c, d, a, 51,  5, 21);
+        AOC_MD5_STEP(AOC_MD5_I(b,c,d), a, b, c, d, 52, 12,  6);
+        AOC_MD5_STEP(AOC_MD5_I(a,b,c), d, a, b, c, 53,  3, 10);
+        AOC_MD5_STEP(AOC_MD5_I(d,a,b), c, d, a, b, 54, 10, 15);
+        AOC_MD5_STEP(AOC_MD5_I(c,d,a), b, c, d, a, 55,  1, 21);
+        AOC_MD5_STEP(AOC_MD5_I(b,c,d), a, b, c, d, 56,  8,  6);
+        AOC_MD5_STEP(AOC_MD5_I(a,b,c), d, a, b, c, 57, 15, 10);
+        AOC_MD5_STEP(AOC_MD5_I(d,a,b), c, d, a, b, 58,  6, 15);
+        AOC_MD5_STEP(AOC_MD5_I(c,d,a), b, c, d, a, 59, 13, 21);
+        AOC_MD5_STEP(AOC_MD5_I(b,c,d), a, b, c, d, 60,  4,  6);
+        AOC_MD5_STEP(AOC_MD5_I(a,b,c), d, a, b, c, 61, 11, 10);
+        AOC_MD5_STEP(AOC_MD5_I(d,a,b), c, d, a, b, 62,  2, 15);
+        AOC_MD5_STEP(AOC_MD5_I(c,d,a), b, c, d, a, 63,  9, 21);
+
+        s.a += a;
+        s.b += b;
+        s.c += c;
+        s.d += d;
+    }
+
+#undef AOC_MD5_STEP
+#undef AOC_MD5_F
+#undef AOC_MD5_G
+#undef AOC_MD5_H
+#undef AOC_MD5_I
+
+    // Little-endian load/store, whatever the host
+    inline std::uint32_t load_le32(const unsigned char* p)
+    {
+        return  std::uint32_t(p[0])        | (std::uint32_t(p[1]) << 8) |
+               (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+    }
+
+    inline void store_le32(unsigned char* p, std::uint32_t v)
+    {
+        p[0] = v;
+        p[1] = v >> 8;
+        p[2] = v >> 16;
+        p[3] = v >> 24;
+    }
+
+    // Hash the full blocks of data into s, return the number of bytes used
+    inline std::size_t absorb(state<std::uint32_t>& s, std::string_view data)
+    {
+        std::size_t used = 0;
+        std::uint32_t M[16];
+
+        for(; used + BLOCK_LENGTH <= data.size(); used += BLOCK_LENGTH)
+        {
+            for(int w=0; w<16; w++)
+                M[w] = load_le32(reinterpret_cast<const unsigned char*>(data.data()) + used + 4*w);
+
+            transform(s, M);
+        }
+
+        return used;
+    }
+
+    // Final padded block(s) of a message of totalLength bytes, whose last
+    // tail.size() bytes are in tail. Returns the number of blocks: 1 or 2.
+    inline int pad(std::string_view tail, std::uint64_t totalLength, unsigned char blocks[2 * BLOCK_LENGTH])
+    {
+        int nbrBlocks = tail.size() + 9 <= BLOCK_LENGTH ? 1 : 2;
+
+        std::memset(blocks, 0, nbrBlocks * BLOCK_LENGTH);
+        std::memcpy(blocks, tail.data(), tail.size());
+        blocks[tail.size()] = 0x80;
+
+        std::uint64_t bits = totalLength * 8;
+        for(int i=0; i<8; i++)
+            blocks[nbrBlocks * BLOCK_LENGTH - 8 + i] = bits >> (8 * i);
+
+        return nbrBlocks;
+    }
+
+    inline digest to_digest(const state<std::uint32_t>& s)
+    {
+        digest md;
+        store_le32(md.data(),      s.a);
+        store_le32(md.data() + 4,  s.b);
+        store_le32(md.data() + 8,  s.c);
+        store_le32(md.data() + 12, s.d);
+        return md;
+    }
+
+    // One-shot MD5 of data
+    inline digest hash(std::string_view data)
+    {
+        state<std::uint32_t> s = initial_state();
+
+        std::size_t used = absorb(s, data);
+
+        unsigned char blocks[2 * BLOCK_LENGTH];
+        int nbrBlocks = pad(data.substr(used), data.size(), blocks);
+
+        std::uint32_t M[16];
+        for(int b=0; b<nbrBlocks; b++)
+        {
+            for(int w=0; w<16; w++)
+                M[w] = load_le32(blocks + b * BLOCK_LENGTH + 4*w);
+            transform(s, M);
+        }
+
+        return to_digest(s);
+    }
+
+    inline std::string to_hex(const digest& md)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+
+        std::string hex;
+        for(auto byte : md)
+        {
+            hex += hexDigits[byte >> 4];
+            hex += hexDigits[byte & 0xf];
+        }
+        return hex;
+    }
+}
+}
+
+#endif  // MYMD5_H
@@ -15,6 +15,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <math.h>
+#include <type_traits>
 
 namespace myutils
 {
@@ -49,6 +50,54 @@ read_file(
     }
 
 
+// Same, but returning the buffer.
+template <typename T_value = char,
+          typename T_container = std::vector<T_value>>
+auto read_file(const std::string filename, bool keepSpaces=false, const bool debug=false)
+    {
+        T_container buffer;
+
+        std::ifstream file(filename);
+
+        bool linesRead = false;
+
+        // Whole lines only make sense for a container of strings
+        if constexpr (std::is_same<typename T_container::value_type, std::string>::value)
+        {
+            if(keepSpaces)
+            {
+                while(file.good())
+                {
+                    std::string line;
+                    getline(file, line);
+                    if(line.size() > 0)
+                        buffer.push_back(line);
+                }
+                linesRead = true;
+            }
+        }
+
+        if(!linesRead)
+        {
+            std::copy(
+                std::istream_iterator<T_value>(file),
+                std::istream_iterator<T_value>(),
+                std::back_inserter(buffer)
+            );
+        }
+
+        if(debug)
+        {
+            std::cout << "Buffer len: " << buffer.size() << std::endl;
+
+            for (auto& val : buffer)
+                std::cout << val << std::endl;
+        }
+
+        return buffer;
+    }
+
+
 template <typename T_value = char,
           typename T_container = std::vector<T_value>>
     auto read_file_csv(const std::string filename, const bool debug=false, char sepValue=',')
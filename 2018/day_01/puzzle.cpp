@@ -1,10 +1,100 @@
 #include <iostream>
+#include <cassert>
 #include <vector>
-#include <set>
+#include <algorithm>
+#include <optional>
+#include <tuple>
 #include "include/myutils.h"
 
 using namespace std;
 
+// Function for puzzle #2
+//
+// First frequency reached twice when the deltas are applied over and over,
+// starting at 0, or nothing if no frequency ever repeats.
+//
+// The frequency before delta i of pass m is f[i] + m*D, where f[i] is the
+// frequency before delta i of the first pass and D the drift of a pass.
+// - A repeat inside the first pass is found by sorting the f[i].
+// - Otherwise f[j] + k*D == f[i] needs f[i] == f[j] (mod |D|): within each
+//   residue class sorted by value, the first repeat of f[j] is its
+//   neighbour one step in the direction of the drift, at time k*n + j.
+// No pass is simulated: O(n log n), whatever the number of passes.
+std::optional<long long> first_repeated_frequency(const std::vector<int>& deltas)
+{
+  const long long n = deltas.size();
+  if (n == 0)
+    return 0;
+
+  std::vector<long long> f(n);
+  long long drift = 0;
+  for (long long i=0; i<n; i++)
+  {
+    f[i] = drift;
+    drift += deltas[i];
+  }
+
+  // Repeat inside the first pass: equal values, earliest second index
+  std::vector<std::pair<long long, long long>> byValue(n);
+  for (long long i=0; i<n; i++)
+    byValue[i] = {f[i], i};
+  std::sort(byValue.begin(), byValue.end());
+
+  long long bestTime = -1;
+  long long bestValue = 0;
+  for (long long i=1; i<n; i++)
+  {
+    if (byValue[i].first == byValue[i-1].first &&
+        (bestTime < 0 || byValue[i].second < bestTime))
+    {
+      bestTime = byValue[i].second;
+      bestValue = byValue[i].first;
+    }
+  }
+
+  if (bestTime >= 0)
+    return bestValue;
+
+  // Every frequency comes back one pass later
+  if (drift == 0)
+    return f[0];
+
+  const long long period = drift > 0 ? drift : -drift;
+
+  // (residue, value in the direction of the drift, index)
+  std::vector<std::tuple<long long, long long, long long>> classes(n);
+  for (long long i=0; i<n; i++)
+  {
+    long long residue = ((f[i] % period) + period) % period;
+    classes[i] = {residue, drift > 0 ? f[i] : -f[i], i};
+  }
+  std::sort(classes.begin(), classes.end());
+
+  for (long long i=0; i+1<n; i++)
+  {
+    auto [residue, value, j] = classes[i];
+    auto [nextResidue, nextValue, next] = classes[i+1];
+
+    if (residue != nextResidue)
+      continue;
+
+    // f[j] reaches f[next] after k more passes
+    long long k = (nextValue - value) / period;
+    long long time = k * n + j;
+
+    if (bestTime < 0 || time < bestTime)
+    {
+      bestTime = time;
+      bestValue = f[next];
+    }
+  }
+
+  if (bestTime < 0)
+    return std::nullopt;
+
+  return bestValue;
+}
+
 int main(int argc, char *argv[])
 {
     // Need a command-line parameter for the input filename
@@ -25,35 +115,22 @@ int main(int argc, char *argv[])
     auto delta_freq = myutils::read_file<int, std::vector<int> >(argv[1]);
 
     // Puzzle #1
-    auto final_freq = 0;
+    long long final_freq = 0;
     for (auto& df : delta_freq)
         final_freq += df;
 
     std::cout << "Answer puzzle #1: "<< final_freq << std::endl;
 
     // Puzzle #2
-    int cur_freq = 0;
-    std::set<int> visited_freq;
-    bool found = false;
-
-    while(!found)
-    {
-        for (auto& df : delta_freq)
-	{
-            cur_freq += df;
-            const bool is_in = visited_freq.find(cur_freq) != visited_freq.end();
-            if (is_in)
-	    {
-                std::cout << "Answer puzzle #2: " << cur_freq << std::endl;
-                found = true;
-                break;
-	    }
-            else
-	    {
-                //std::cout << "Delta_freq: " << df << ": Cur freq: " << cur_freq << std::endl;
-                visited_freq.insert(cur_freq);
-	    }
-	}
-    }
+    assert(first_repeated_frequency({+1, -1}) == 0 && "Error verifying puzzle #2");
+    assert(first_repeated_frequency({+3, +3, +4, -2, -4}) == 10 && "Error verifying puzzle #2");
+    assert(first_repeated_frequency({-6, +3, +8, +5, -6}) == 5 && "Error verifying puzzle #2");
+    assert(first_repeated_frequency({+7, +7, -2, -7, -4}) == 14 && "Error verifying puzzle #2");
+    assert(first_repeated_frequency({+1, -2, +3, +1}) == 2 && "Error verifying puzzle #2");
 
+    auto repeated = first_repeated_frequency(delta_freq);
+    if (repeated)
+        std::cout << "Answer puzzle #2: " << *repeated << std::endl;
+    else
+        std::cout << "Answer puzzle #2: no frequency is ever reached twice" << std::endl;
 }
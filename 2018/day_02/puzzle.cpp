@@ -1,20 +1,45 @@
 #include <iostream>
+#include <cassert>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <set>
-#include <map>
+#include <unordered_map>
+#include <optional>
 #include <algorithm>
+#include <cstdint>
 
 #include "include/myutils.h"
 
 using namespace std;
 
+// Function for puzzle #1
+// Does the id hold some letter exactly 2 times, exactly 3 times
+std::pair<bool, bool> has_2_and_3(const std::string& id)
+{
+  int counts[26] = {};
+
+  for (char c : id)
+  {
+    if (c >= 'a' && c <= 'z')
+      counts[c - 'a']++;
+  }
+
+  bool has2 = false;
+  bool has3 = false;
+  for (int n : counts)
+  {
+    has2 |= (n == 2);
+    has3 |= (n == 3);
+  }
+  return {has2, has3};
+}
+
 // Function for puzzle #2
-std::string find_differences(std::string s1, std::string s2)
+std::string find_differences(const std::string& s1, const std::string& s2)
 {
   std::string retValue = "";
 
-  for (int k=0; k< s1.size(); k++)
+  for (size_t k=0; k< s1.size(); k++)
   {
     if (s1[k] == s2[k])
       retValue.append(1, s1[k]);
@@ -23,6 +48,146 @@ std::string find_differences(std::string s1, std::string s2)
 
 }
 
+int count_differences(const std::string& s1, const std::string& s2)
+{
+  if (s1.size() != s2.size())
+    return -1;
+
+  int n = 0;
+  for (size_t k=0; k<s1.size(); k++)
+    n += (s1[k] != s2[k]);
+  return n;
+}
+
+// Function for puzzle #2
+// First pair of ids differing in exactly one position.
+//
+// Each id is hashed with each position masked out: two ids differing only
+// at position p have the same hash for p. With a polynomial hash, masking
+// p is removing id[p] * BASE^(L-1-p) from the full hash, so the search is
+// O(n*L) expected with O(n) memory: one full hash per id, one hash table
+// per position, and no string built. The hash is not exact: every id of a
+// key is chained, and a new id is verified against the whole chain.
+std::optional<std::pair<int, int>> find_pair_one_apart(const std::vector<std::string>& ids)
+{
+  const uint64_t BASE = 1000003;
+
+  size_t length = 0;
+  for (auto& id : ids)
+    length = std::max(length, id.size());
+
+  std::vector<uint64_t> power(length + 1, 1);
+  for (size_t p=1; p<=length; p++)
+    power[p] = power[p-1] * BASE;
+
+  // Hashes of the ids padded with zeros to the common length L
+  const size_t n = ids.size();
+  std::vector<uint64_t> full(n, 0);
+
+  for (size_t i=0; i<n; i++)
+  {
+    for (unsigned char c : ids[i])
+      full[i] = full[i] * BASE + c;
+    full[i] *= power[length - ids[i].size()];
+  }
+
+  // Open addressing table of the last id seen for each key (-1: empty),
+  // the key of each id, and the previous id of the same key
+  size_t capacity = 1;
+  while (capacity < 2 * n)
+    capacity *= 2;
+  const int shift = 64 - __builtin_ctzll(capacity);
+
+  std::vector<int> last(capacity);
+  std::vector<uint64_t> keys(n);
+  std::vector<int> chain(n);
+
+  for (size_t p=0; p<length; p++)
+  {
+    std::fill(last.begin(), last.end(), -1);
+
+    for (size_t i=0; i<n; i++)
+    {
+      unsigned char c = p < ids[i].size() ? ids[i][p] : 0;
+      uint64_t key = full[i] - c * power[length - 1 - p];
+      keys[i] = key;
+
+      size_t slot = shift < 64 ? (key * 0x9e3779b97f4a7c15ULL) >> shift : 0;
+      while (last[slot] >= 0 && keys[last[slot]] != key)
+        slot = (slot + 1) & (capacity - 1);
+
+      chain[i] = last[slot];
+      last[slot] = i;
+
+      for (int j=chain[i]; j>=0; j=chain[j])
+      {
+        if (count_differences(ids[j], ids[i]) == 1)
+          return std::make_pair(j, (int)i);
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+// Function for puzzle #2, generalized
+// First pair of distinct ids differing in at most k positions: the ids
+// are grouped by their value with every set of k positions masked out,
+// C(L, k) groupings of n ids. These keys are exact: the ids of a group only
+// differ in the masked positions, so checking against the first one is enough.
+std::optional<std::pair<int, int>> find_pair_within(const std::vector<std::string>& ids, int k)
+{
+  size_t length = 0;
+  for (auto& id : ids)
+    length = std::max(length, id.size());
+
+  if (k <= 0 || length == 0)
+    return std::nullopt;
+  k = std::min<int>(k, length);
+
+  // Current set of masked positions, increasing
+  std::vector<int> masked(k);
+  for (int m=0; m<k; m++)
+    masked[m] = m;
+
+  std::unordered_map<std::string, int> seen;
+  std::string key;
+
+  while (true)
+  {
+    seen.clear();
+
+    for (size_t i=0; i<ids.size(); i++)
+    {
+      key.assign(ids[i]);
+      key.resize(length, '\0');
+      for (int m : masked)
+        key[m] = '\1';
+
+      auto [it, isNew] = seen.emplace(key, i);
+      if (!isNew)
+      {
+        int d = count_differences(ids[it->second], ids[i]);
+        if (d > 0 && d <= k)
+          return std::make_pair(it->second, (int)i);
+      }
+    }
+
+    // Next combination
+    int m = k - 1;
+    while (m >= 0 && masked[m] == (int)length - k + m)
+      m--;
+    if (m < 0)
+      break;
+
+    masked[m]++;
+    for (int j=m+1; j<k; j++)
+      masked[j] = masked[j-1] + 1;
+  }
+
+  return std::nullopt;
+}
+
 int main(int argc, char *argv[])
 {
     // Need a command-line parameter for the input filename
@@ -50,52 +215,38 @@ int main(int argc, char *argv[])
     int nbrs3 = 0;
     for (auto& idd : ids)
     {
-        std::map<char, int> char_counter;
-        std::set<int>       multiples;
-
-        // count occurences of characters
-        for (auto& c : idd)
-        {
-            char_counter[c] = char_counter[c] + 1;
-        }
-
-        // Use a set to find individual totals
-        for(auto&p : char_counter)
-        {
-            multiples.insert(p.second);
-            // std::cout << "Key: " << p.first << " : Value: " << p.second << std::endl;
-        }
-
-        // Find 2s and 3s
-        for(auto&p : multiples)
-        {
-            // std::cout << "multiples: " << p << std::endl;
-
-            if (p == 2)
-                nbrs2++;
-            else if (p == 3)
-                nbrs3++;
-        }
+        auto [has2, has3] = has_2_and_3(idd);
+        nbrs2 += has2;
+        nbrs3 += has3;
     }
     int checksum = nbrs2 * nbrs3;
-    // Report
-    // std::cout << "Nbr of 2s: " << nbrs2 << std::endl;
-    // std::cout << "Nbr of 3s: " << nbrs3 << std::endl;
 
     std::cout << "Answer puzzle #1: " << checksum << std::endl;
 
     // Puzzle #2
-    for (int i=0; i<ids.size(); i++)
+    const std::vector<std::string> example2 = {"abcde", "fghij", "klmno", "pqrst", "fguij", "axcye", "wvxyz"};
+    auto examplePair = find_pair_one_apart(example2);
+    assert(examplePair && find_differences(example2[examplePair->first], example2[examplePair->second]) == "fgij" && "Error verifying puzzle #2");
+    assert(find_pair_within(example2, 1) == examplePair && "Error verifying puzzle #2");
+    const std::vector<std::string> twoApart = {"abcde", "klmno", "axcye", "pqrst"};
+    assert(!find_pair_within(twoApart, 1) && "Error verifying puzzle #2");
+    assert(find_pair_within(twoApart, 2) == std::make_pair(0, 2) && "Error verifying puzzle #2");
+
+    // The Thue-Morse word of length 1024 and its complement have the same
+    // hash: ids 0 and 1 collide with the actual pair, 1 and 2
+    std::string thueMorse, complement;
+    for (int i=0; i<1024; i++)
     {
-        for (int j=i; j<ids.size(); j++)
-        {
-            std::string common_chars = find_differences(ids[i], ids[j]);
-
-            if(common_chars.size() == ids[i].size() - 1)
-            {
-                std::cout << "Answer puzzle #2: " << common_chars << std::endl;
-            }
-        }
+      bool odd = __builtin_popcount(i) % 2;
+      thueMorse += odd ? 'b' : 'a';
+      complement += odd ? 'a' : 'b';
     }
+    const std::vector<std::string> colliding = {thueMorse + "x", complement + "y", complement + "z"};
+    assert(find_pair_one_apart(colliding) == std::make_pair(1, 2) && "Error verifying puzzle #2");
 
+    auto pair = find_pair_one_apart(ids);
+    if (pair)
+    {
+        std::cout << "Answer puzzle #2: " << find_differences(ids[pair->first], ids[pair->second]) << std::endl;
+    }
 }
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cassert>
 #include <vector>
 #include <set>
 #include <string>
@@ -35,104 +36,420 @@ struct patch {
     }
 };
 
-using namespace std;
+// Result of both puzzles
+struct overlap_result
+{
+    long long overlappedArea = 0;       // Cells claimed 2 times or more
+    std::vector<int> intactClaims;      // Claims overlapping no other claim
+};
 
-int main(int argc, char *argv[])
+// Dense mode: 2D difference array on the heap, over the bounding box.
+// O(claims + area) time, one int and one int64 per cell.
+overlap_result overlap_dense(const std::vector<patch>& claims)
 {
-    // Need a command-line parameter for the input filename
-    if (argc != 2) {
-        cerr << "Error: missing input" << endl;
-        return EXIT_FAILURE;
+    overlap_result result;
+
+    long long width = 0;
+    long long height = 0;
+    for (auto& p : claims)
+    {
+        width  = std::max<long long>(width,  p.offset_x + p.size_x);
+        height = std::max<long long>(height, p.offset_y + p.size_y);
     }
 
-    string filename(argv[1]);
+    // +1 on the rectangle corner, -1 past its edges
+    const long long stride = width + 1;
+    std::vector<int> cloth((width + 1) * (height + 1), 0);
 
-    // This file needs to exist
-    if (! myutils::file_exists(filename))
+    for (auto& p : claims)
     {
-        cerr << "Error: nonexistent file: " << filename << endl;
-        return EXIT_FAILURE;
+        long long x1 = p.offset_x, x2 = p.offset_x + p.size_x;
+        long long y1 = p.offset_y, y2 = p.offset_y + p.size_y;
+
+        cloth[y1 * stride + x1] += 1;
+        cloth[y1 * stride + x2] -= 1;
+        cloth[y2 * stride + x1] -= 1;
+        cloth[y2 * stride + x2] += 1;
     }
 
-    // Reading the data
-    std::vector<patch> listPatch = myutils::read_file<patch, std::vector<patch> >(filename);
+    // Running sums: claims per cell. Then the prefix sums of the claims per
+    // cell, one row ahead: multiClaimed[y+1][x+1] = sum of cloth[<=y][<=x]
+    std::vector<long long> prefix((width + 1) * (height + 1), 0);
 
-    // Puzzle #1
-    // Puzzle #1
-    int maxSizeX = 0;
-    int maxSizeY = 0;
+    for (long long y=0; y<height; y++)
+    {
+        for (long long x=0; x<width; x++)
+        {
+            int& c = cloth[y * stride + x];
+            if (x > 0)
+                c += cloth[y * stride + x - 1];
+            if (y > 0)
+                c += cloth[(y - 1) * stride + x];
+            if (x > 0 && y > 0)
+                c -= cloth[(y - 1) * stride + x - 1];
 
-    for (auto& p : listPatch)
+            result.overlappedArea += (c > 1);
+
+            prefix[(y + 1) * stride + x + 1] = c
+                + prefix[y * stride + x + 1]
+                + prefix[(y + 1) * stride + x]
+                - prefix[y * stride + x];
+        }
+    }
+
+    // Intact: the claims over the rectangle add up to its area
+    for (auto& p : claims)
     {
-        int sizeX = p.offset_x + p.size_x;
-        int sizeY = p.offset_y + p.size_y;
+        long long x1 = p.offset_x, x2 = p.offset_x + p.size_x;
+        long long y1 = p.offset_y, y2 = p.offset_y + p.size_y;
 
-        if(sizeX > maxSizeX)
-            maxSizeX = sizeX;
+        long long sum = prefix[y2 * stride + x2] - prefix[y1 * stride + x2]
+                      - prefix[y2 * stride + x1] + prefix[y1 * stride + x1];
 
-        if(sizeY > maxSizeY)
-            maxSizeY = sizeY;
+        if (sum == (long long)p.size_x * p.size_y)
+            result.intactClaims.push_back(p.number);
     }
 
-    // std::cout << "maxSizeX: "<< maxSizeX << std::endl;
-    // std::cout << "maxSizeY: "<< maxSizeY << std::endl;
+    return result;
+}
+
+// Segment tree over the elementary y intervals between the claim edges:
+// length covered once or more, twice or more
+class coverage_tree
+{
+    const std::vector<long long>& ys_;
+    std::vector<int> count_;
+    std::vector<long long> len1_;
+    std::vector<long long> len2_;
+    int size_;
 
-    int cloth[maxSizeX][maxSizeY];
-    // std::cout << "Size of cloth: " << sizeof(cloth) << std::endl;
+    void pull(int node, int lo, int hi)
+    {
+        long long length = ys_[hi] - ys_[lo];
+        bool leaf = (hi - lo == 1);
 
-    std::fill( &cloth[0][0], &cloth[0][0] + maxSizeX*maxSizeY, 0 );
+        long long child1 = leaf ? 0 : len1_[2*node] + len1_[2*node + 1];
+        long long child2 = leaf ? 0 : len2_[2*node] + len2_[2*node + 1];
 
-    // Fill cloth with patches
-    for (auto& p : listPatch)
+        if (count_[node] >= 2)
+        {
+            len1_[node] = len2_[node] = length;
+        }
+        else if (count_[node] == 1)
+        {
+            len1_[node] = length;
+            len2_[node] = child1;
+        }
+        else
+        {
+            len1_[node] = child1;
+            len2_[node] = child2;
+        }
+    }
+
+    void add(int node, int lo, int hi, int a, int b, int delta)
     {
-        for (int x=p.offset_x; x<p.offset_x + p.size_x; x++)
+        if (b <= lo || hi <= a)
+            return;
+
+        if (a <= lo && hi <= b)
         {
-            for (int y=p.offset_y; y<p.offset_y + p.size_y; y++)
-            {
-                cloth[x][y] += 1;
-            }
+            count_[node] += delta;
         }
+        else
+        {
+            int mid = (lo + hi) / 2;
+            add(2*node, lo, mid, a, b, delta);
+            add(2*node + 1, mid, hi, a, b, delta);
+        }
+        pull(node, lo, hi);
+    }
+
+public:
+
+    explicit coverage_tree(const std::vector<long long>& ys)
+        : ys_(ys),
+          count_(4 * ys.size(), 0),
+          len1_(4 * ys.size(), 0),
+          len2_(4 * ys.size(), 0),
+          size_(ys.size() - 1)
+    {}
+
+    // Add delta to the elementary intervals [a, b)
+    void add(int a, int b, int delta)
+    {
+        add(1, 0, size_, a, b, delta);
+    }
+
+    long long covered_twice() const
+    {
+        return len2_[1];
+    }
+};
+
+// Max tree over the claims sorted by top edge: the leaf of an active claim
+// holds its bottom edge, -1 otherwise
+class bottom_edge_tree
+{
+    std::vector<long long> max_;
+    int leaves_;
 
+public:
+
+    explicit bottom_edge_tree(int n)
+    {
+        leaves_ = 1;
+        while (leaves_ < n)
+            leaves_ *= 2;
+        max_.assign(2 * leaves_, -1);
+    }
+
+    void set(int leaf, long long value)
+    {
+        int node = leaves_ + leaf;
+        max_[node] = value;
+        for (node /= 2; node >= 1; node /= 2)
+            max_[node] = std::max(max_[2*node], max_[2*node + 1]);
     }
 
-    // Compute common area
-    int commonArea = 0;
-    for(int x=0; x< maxSizeX; x++)
+    // Leaves in [0, end) with a value above y, in any order, removed
+    // from the tree if remove is true
+    template <typename F>
+    void for_each_above(int end, long long y, bool remove, F f, int node = 1, int lo = 0, int hi = -1)
     {
-        for (int y=0; y< maxSizeY; y++)
+        if (hi < 0)
+            hi = leaves_;
+
+        if (lo >= end || max_[node] <= y)
+            return;
+
+        if (hi - lo == 1)
         {
-            if (cloth[x][y] > 1)
-            {
-                commonArea++;
-            }
+            f(lo);
+            if (remove)
+                set(lo, -1);
+            return;
         }
+
+        int mid = (lo + hi) / 2;
+        for_each_above(end, y, remove, f, 2*node, lo, mid);
+        for_each_above(end, y, remove, f, 2*node + 1, mid, hi);
     }
 
-    std::cout << "Answer puzzle #1: " << commonArea << std::endl;
+    // Some leaf in [0, end) with a value above y
+    bool any_above(int end, long long y, int node = 1, int lo = 0, int hi = -1) const
+    {
+        if (hi < 0)
+            hi = leaves_;
 
-    // Puzzle #2
-    // intact claim
+        if (lo >= end || max_[node] <= y)
+            return false;
+
+        if (hi - lo == 1)
+            return true;
 
-    for (auto& p : listPatch)
+        int mid = (lo + hi) / 2;
+        return any_above(end, y, 2*node, lo, mid) || any_above(end, y, 2*node + 1, mid, hi);
+    }
+};
+
+// Sweep mode, for sparse or huge fabrics: O(claims log claims), whatever
+// the coordinates.
+//
+// A vertical line sweeps the claim edges in x.
+// - Overlapped area: coverage_tree gives the y length covered twice or
+//   more between two consecutive edges.
+// - Intact claims: when a claim starts, the active claims whose y interval
+//   intersects its own are those with a top edge below its bottom edge and
+//   a bottom edge below its top edge: a prefix of the claims sorted by top
+//   edge, filtered on the bottom edge with a max tree. A second tree holds
+//   only the claims not yet known to overlap, and each of them is reported
+//   once, so the whole sweep stays O(n log n).
+overlap_result overlap_sweep(const std::vector<patch>& claims)
+{
+    overlap_result result;
+
+    const int n = claims.size();
+    if (n == 0)
+        return result;
+
+    std::vector<long long> ys;
+    for (auto& p : claims)
+    {
+        ys.push_back(p.offset_y);
+        ys.push_back((long long)p.offset_y + p.size_y);
+    }
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+    auto y_index = [&](long long y)
+    {
+        return int(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin());
+    };
+
+    // Claims by top edge, and the leaf of each claim
+    std::vector<int> byTop(n);
+    for (int i=0; i<n; i++)
+        byTop[i] = i;
+    std::sort(byTop.begin(), byTop.end(), [&](int a, int b) { return claims[a].offset_y < claims[b].offset_y; });
+
+    std::vector<long long> tops(n);
+    std::vector<int> leafOf(n);
+    for (int k=0; k<n; k++)
+    {
+        tops[k] = claims[byTop[k]].offset_y;
+        leafOf[byTop[k]] = k;
+    }
+
+    // (x, claim, start): ends first at the same x, the claims are half-open
+    struct event
+    {
+        long long x;
+        int claim;
+        bool start;
+    };
+
+    // The empty claims cover no cell: they overlap nothing, and stay out of
+    // the sweep (a zero width claim would end before it starts)
+    std::vector<event> events;
+    events.reserve(2 * n);
+    for (int i=0; i<n; i++)
+    {
+        if (claims[i].size_x == 0 || claims[i].size_y == 0)
+            continue;
+
+        events.push_back({claims[i].offset_x, i, true});
+        events.push_back({(long long)claims[i].offset_x + claims[i].size_x, i, false});
+    }
+    std::sort(events.begin(), events.end(), [](const event& a, const event& b)
+    {
+        return a.x != b.x ? a.x < b.x : (!a.start && b.start);
+    });
+
+    coverage_tree coverage(ys);
+    bottom_edge_tree active(n);
+    bottom_edge_tree activeIntact(n);
+    std::vector<bool> overlaps(n, false);
+
+    for (size_t e=0; e<events.size(); e++)
     {
-        bool overLap = false;
+        const event& ev = events[e];
+        const patch& p = claims[ev.claim];
+
+        long long top = p.offset_y;
+        long long bottom = (long long)p.offset_y + p.size_y;
 
-        for (int x=p.offset_x; x<p.offset_x + p.size_x; x++)
+        if (ev.start)
         {
-            for (int y=p.offset_y; y<p.offset_y + p.size_y; y++)
+            // Active claims with top < bottom and bottom > top
+            int end = int(std::lower_bound(tops.begin(), tops.end(), bottom) - tops.begin());
+
+            if (active.any_above(end, top))
             {
-                if(cloth[x][y] != 1)
-                {
-                    overLap = true;
-                }
+                overlaps[ev.claim] = true;
+                activeIntact.for_each_above(end, top, true, [&](int leaf) { overlaps[byTop[leaf]] = true; });
             }
-        }
 
-        if(!overLap)
+            active.set(leafOf[ev.claim], bottom);
+            if (!overlaps[ev.claim])
+                activeIntact.set(leafOf[ev.claim], bottom);
+        }
+        else
         {
-            std::cout << "Answer puzzle #2: " << p.number << std::endl;
+            active.set(leafOf[ev.claim], -1);
+            activeIntact.set(leafOf[ev.claim], -1);
         }
 
+        coverage.add(y_index(top), y_index(bottom), ev.start ? 1 : -1);
+
+        if (e + 1 < events.size())
+            result.overlappedArea += coverage.covered_twice() * (events[e + 1].x - ev.x);
+    }
+
+    for (int i=0; i<n; i++)
+        if (!overlaps[i])
+            result.intactClaims.push_back(claims[i].number);
+
+    return result;
+}
+
+// Dense difference array when the bounding box is small enough
+overlap_result overlap(const std::vector<patch>& claims)
+{
+    // overlap_dense() takes an int and a long long per cell: 64 MB at most,
+    // about 2^22 cells
+    const long long MAX_DENSE_BYTES = 64LL << 20;
+    const long long MAX_DENSE_CELLS = MAX_DENSE_BYTES / (sizeof(int) + sizeof(long long));
+
+    long long width = 0;
+    long long height = 0;
+    for (auto& p : claims)
+    {
+        width  = std::max<long long>(width,  p.offset_x + p.size_x);
+        height = std::max<long long>(height, p.offset_y + p.size_y);
+    }
+
+    if ((width + 1) * (height + 1) <= MAX_DENSE_CELLS)
+        return overlap_dense(claims);
+
+    return overlap_sweep(claims);
+}
+
+int main(int argc, char *argv[])
+{
+    // Need a command-line parameter for the input filename
+    if (argc != 2) {
+        cerr << "Error: missing input" << endl;
+        return EXIT_FAILURE;
+    }
+
+    string filename(argv[1]);
+
+    // This file needs to exist
+    if (! myutils::file_exists(filename))
+    {
+        cerr << "Error: nonexistent file: " << filename << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Reading the data
+    std::vector<patch> listPatch = myutils::read_file<patch, std::vector<patch> >(filename);
+
+    // Verify the examples, with both modes
+    std::vector<patch> example;
+    for (auto line : {"#1 @ 1,3: 4x4", "#2 @ 3,1: 4x4", "#3 @ 5,5: 2x2"})
+    {
+        patch p;
+        std::istringstream(line) >> p;
+        example.push_back(p);
+    }
+
+    for (auto& r : {overlap_dense(example), overlap_sweep(example)})
+    {
+        assert(r.overlappedArea == 4 && "Error verifying puzzle #1");
+        assert(r.intactClaims == std::vector<int>{3} && "Error verifying puzzle #2");
+    }
+
+    // An empty claim covers nothing, so it overlaps nothing
+    patch empty;
+    std::istringstream("#4 @ 2,0: 0x9") >> empty;
+    example.push_back(empty);
+
+    for (auto& r : {overlap_dense(example), overlap_sweep(example)})
+    {
+        assert(r.overlappedArea == 4 && "Error verifying puzzle #1");
+        assert(r.intactClaims == (std::vector<int>{3, 4}) && "Error verifying puzzle #2");
     }
 
+    overlap_result result = overlap(listPatch);
+
+    // Puzzle #1
+    std::cout << "Answer puzzle #1: " << result.overlappedArea << std::endl;
+
+    // Puzzle #2
+    // intact claim
+    for (int number : result.intactClaims)
+    {
+        std::cout << "Answer puzzle #2: " << number << std::endl;
+    }
 }
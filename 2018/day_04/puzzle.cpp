@@ -1,13 +1,13 @@
 #include <iostream>
+#include <cassert>
 #include <vector>
 #include <string>
-#include <set>
-#include <map>
+#include <string_view>
 #include <fstream>
-#include <algorithm>
-#include <functional>
-#include <numeric>
 #include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
 #include "include/myutils.h"
 
 using namespace std;
@@ -41,36 +41,39 @@ struct Log {
         {
         }
 
-    friend std::istream & operator >>(std::istream & in, Log & l)
+    // "[1518-11-01 00:05] falls asleep", scanned in place
+    static bool parse(std::string_view line, Log& l)
     {
-        char c;
-        std::string cur_state;
-
-        in  >> c
-            >> l.year
-            >> c
-            >> l.month
-            >> c
-            >> l.day
-            >> l.hour
-            >> c
-            >> l.minute
-            >> c ;
-
-
-        getline(in, cur_state);
+        size_t pos = 0;
 
-        if(cur_state.find("Guard") != std::string::npos)
+        auto number = [&]() -> int
         {
-            std::string scrap;
-            std::istringstream ssGuard(cur_state);
-            ssGuard >> scrap;
-            ssGuard >> c;
-            ssGuard >> l.guardID;
-
+            while (pos < line.size() && (line[pos] < '0' || line[pos] > '9'))
+                pos++;
+            int value = 0;
+            while (pos < line.size() && line[pos] >= '0' && line[pos] <= '9')
+                value = value * 10 + (line[pos++] - '0');
+            return value;
+        };
+
+        if (line.find('[') == std::string_view::npos)
+            return false;
+
+        l.year   = number();
+        l.month  = number();
+        l.day    = number();
+        l.hour   = number();
+        l.minute = number();
+        l.guardID = -1;
+
+        std::string_view text = line.substr(pos);
+
+        if (text.find("Guard") != std::string_view::npos)
+        {
+            l.guardID = number();
             l.state = BEGIN_SHIFT;
         }
-        else if(cur_state.find("wakes up") != std::string::npos)
+        else if (text.find("wakes up") != std::string_view::npos)
         {
             l.state = AWAKE;
         }
@@ -79,143 +82,221 @@ struct Log {
             l.state = ASLEEP;
         }
 
-        return in;
+        return true;
+    }
+
+    // Minutes since the start of firstYear, in a calendar with 31-day
+    // months: only the order matters
+    long long timestamp(int firstYear) const
+    {
+        return ((((long long)(year - firstYear) * 12 + (month - 1)) * 31 + (day - 1)) * 24 + hour) * 60 + minute;
     }
+};
 
+// LSD radix sort of 64-bit keys, 8 bits per pass. The passes where all
+// the keys share the same byte are skipped.
+void radix_sort(std::vector<uint64_t>& keys)
+{
+    std::vector<uint64_t> buffer(keys.size());
 
-    friend std::ostream& operator<<(std::ostream& os, const Log& l)
+    for (int shift=0; shift<64; shift+=8)
     {
-        return os << "   Year: " << l.year
-            << " : Month: " << l.month
-            << " : Day " << l.day
-            << " : Hour: " << l.hour
-            << " : Minute: " << l.minute
-            << " : State: " <<  (l.state == AWAKE? "AWAKE" : (l.state == ASLEEP ? "ASLEEP" : "BEGIN_SHIFT"))
-            << " : GuardID: " << l.guardID;
+        size_t count[256] = {};
+        for (auto k : keys)
+            count[(k >> shift) & 0xff]++;
+
+        if (std::find(std::begin(count), std::end(count), keys.size()) != std::end(count))
+            continue;
+
+        size_t offset = 0;
+        for (auto& c : count)
+        {
+            size_t n = c;
+            c = offset;
+            offset += n;
+        }
+
+        for (auto k : keys)
+            buffer[count[(k >> shift) & 0xff]++] = k;
+
+        keys.swap(buffer);
     }
+}
 
+// Answers of both strategies
+struct guard_report
+{
+    long long strategy1 = -1;   // Most asleep guard x its most asleep minute
+    long long strategy2 = -1;   // Guard x minute most often asleep
 };
 
-int main(int argc, char *argv[])
+// Sleep statistics of the guards, from the log lines in any order.
+//
+// The timestamps are packed with the line index into 64-bit keys, radix
+// sorted, and the sleep minutes are added to one 60-minute histogram per
+// guard, in a flat array indexed by interned guard id.
+guard_report analyze_logs(const std::vector<Log>& logs)
 {
-    // Need a command-line parameter for the input filename
-    if (argc != 2) {
-        cerr << "Error: missing input" << endl;
-        return EXIT_FAILURE;
-    }
+    guard_report report;
 
-    string filename(argv[1]);
+    const size_t n = logs.size();
+    if (n == 0)
+        return report;
 
-    // This file needs to exist
-    if (! myutils::file_exists(filename))
-    {
-        cerr << "Error: nonexistent file: " << filename << endl;
-        return EXIT_FAILURE;
-    }
+    int firstYear = logs[0].year;
+    for (auto& l : logs)
+        firstYear = std::min(firstYear, l.year);
 
-    // Reading the data
-    auto listLogs = myutils::read_file<Log, std::vector<Log> >(filename, true);
+    int indexBits = 1;
+    while ((size_t(1) << indexBits) < n)
+        indexBits++;
 
-    // Puzzle #1
-    // Classe la liste par valeur de temps
-    // sort using a custom lambda function object
-    std::sort(listLogs.begin(), listLogs.end(), [] (Log a, Log b)
-    {
-        if (a.year   != b.year)   return a.year   < b.year;
-        if (a.month  != b.month)  return a.month  < b.month;
-        if (a.day    != b.day)    return a.day    < b.day;
-        if (a.hour   != b.hour)   return a.hour   < b.hour;
-        if (a.minute != b.minute) return a.minute < b.minute;
-        return false;
-    }
-    );
+    std::vector<uint64_t> keys(n);
+    for (size_t i=0; i<n; i++)
+        keys[i] = (uint64_t(logs[i].timestamp(firstYear)) << indexBits) | i;
+
+    radix_sort(keys);
 
-    int curGuardID = -1;
+    // Interned guard ids, and their histograms
+    std::unordered_map<int, int> guardIndex;
+    std::vector<int> guardIDs;
+    std::vector<int> minutes;
 
-    // Fill missing guardID info
-    for (auto& l : listLogs)
+    int curGuard = -1;
+    int startSleep = -1;
+
+    for (auto key : keys)
     {
-        if(l.guardID != -1)
+        const Log& l = logs[key & ((uint64_t(1) << indexBits) - 1)];
+
+        switch (l.state)
         {
-            curGuardID = l.guardID;
-        }
-        else
+        case BEGIN_SHIFT:
         {
-            l.guardID = curGuardID;
+            auto [it, isNew] = guardIndex.emplace(l.guardID, guardIDs.size());
+            if (isNew)
+            {
+                guardIDs.push_back(l.guardID);
+                minutes.resize(minutes.size() + 60, 0);
+            }
+            curGuard = it->second;
+            startSleep = -1;
+            break;
+        }
+        case ASLEEP:
+            startSleep = l.minute;
+            break;
+        case AWAKE:
+            if (curGuard >= 0 && startSleep >= 0)
+            {
+                int* histogram = &minutes[curGuard * 60];
+                for (int m=startSleep; m<l.minute; m++)
+                    histogram[m]++;
+            }
+            startSleep = -1;
+            break;
+        default:
+            break;
         }
     }
 
+    // Both strategies in one pass over the histograms
+    long long bestTotal = -1;
+    int bestCount = -1;
 
-#if 1
-    std::cout << "Sorted list" << std::endl;
-    for (auto l : listLogs)
-    {
-        std::cout << l << " ";
-    }
-    std::cout << std::endl;
-#endif
-
-    // Puzzle #1
-    // Memorize current shift in a vector of [sleep:awake:sleep:awake:...:sleep:awake]
-
-    std::map<int, std::vector<int> > sleepTimeByGuard;
-    for (int i=0; i< listLogs.size(); i++)
+    for (size_t g=0; g<guardIDs.size(); g++)
     {
-        int curGuard = listLogs[i].guardID;
+        const int* histogram = &minutes[g * 60];
 
-        // New guard ?
-        if(sleepTimeByGuard.find(curGuard) == sleepTimeByGuard.end())
+        long long total = 0;
+        int bestMinute = 0;
+        for (int m=0; m<60; m++)
         {
-            std::vector<int> sTime(60, 0); // 60 entries initialized to 0
-            sleepTimeByGuard[curGuard] = sTime;
+            total += histogram[m];
+            if (histogram[m] > histogram[bestMinute])
+                bestMinute = m;
         }
 
-        if(listLogs[i].state == ASLEEP)
+        if (total > bestTotal)
         {
-            int startSleep = listLogs[i].minute;
-            int stopSleep  = listLogs[i+1].minute;
-
-            for(int j = startSleep; j< stopSleep; j++)
-            {
-                sleepTimeByGuard[curGuard][j] += 1;
-            }
+            bestTotal = total;
+            report.strategy1 = (long long)guardIDs[g] * bestMinute;
+        }
 
-            i++;
+        if (histogram[bestMinute] > bestCount)
+        {
+            bestCount = histogram[bestMinute];
+            report.strategy2 = (long long)guardIDs[g] * bestMinute;
         }
     }
 
-    int bestGuardSleeper = -1;
-    int maxSleepTime = -1;
-    int preferedSleepTime = -1;
+    return report;
+}
+
+std::vector<Log> parse_logs(std::istream& in)
+{
+    std::vector<Log> logs;
+    std::string line;
 
-    for (auto sTime : sleepTimeByGuard)
+    while (getline(in, line))
     {
-#if 1
-        std::cout << "Guard: " << sTime.first << " : ";
-        for (auto i = sTime.second.begin(); i != sTime.second.end(); ++i)
-            std::cout << *i << ' ';
-#endif
+        Log l;
+        if (Log::parse(line, l))
+            logs.push_back(l);
+    }
+    return logs;
+}
 
-        int accumulateSleepTime = std::accumulate(sTime.second.begin(), sTime.second.end(), 0);
+int main(int argc, char *argv[])
+{
+    // Need a command-line parameter for the input filename
+    if (argc != 2) {
+        cerr << "Error: missing input" << endl;
+        return EXIT_FAILURE;
+    }
 
-        // std::cout << accumulateSleepTime;
-        // std::cout << std::endl;
+    string filename(argv[1]);
 
-        if(accumulateSleepTime > maxSleepTime)
-        {
-            bestGuardSleeper = sTime.first;
-            maxSleepTime = accumulateSleepTime;
-            preferedSleepTime = std::distance(sTime.second.begin(), std::max_element(sTime.second.begin(), sTime.second.end()));
-        }
+    // This file needs to exist
+    if (! myutils::file_exists(filename))
+    {
+        cerr << "Error: nonexistent file: " << filename << endl;
+        return EXIT_FAILURE;
     }
-    std::cout << "Best sleeper: " << bestGuardSleeper << " : sleepTime : " << maxSleepTime << " : preferedSleepTime:: " << preferedSleepTime << std::endl;
-
-    int answer1 = bestGuardSleeper * preferedSleepTime;
-    std::cout << "Answer to puzzle #1 : " << answer1 << std::endl;
 
+    // Reading the data
+    std::ifstream file(filename);
+    auto listLogs = parse_logs(file);
+
+    // Verify the example, shuffled
+    std::istringstream example(
+        "[1518-11-01 00:25] wakes up\n"
+        "[1518-11-01 00:00] Guard #10 begins shift\n"
+        "[1518-11-01 00:05] falls asleep\n"
+        "[1518-11-01 00:30] falls asleep\n"
+        "[1518-11-01 00:55] wakes up\n"
+        "[1518-11-01 23:58] Guard #99 begins shift\n"
+        "[1518-11-02 00:40] falls asleep\n"
+        "[1518-11-02 00:50] wakes up\n"
+        "[1518-11-03 00:05] Guard #10 begins shift\n"
+        "[1518-11-03 00:24] falls asleep\n"
+        "[1518-11-03 00:29] wakes up\n"
+        "[1518-11-04 00:02] Guard #99 begins shift\n"
+        "[1518-11-04 00:36] falls asleep\n"
+        "[1518-11-04 00:46] wakes up\n"
+        "[1518-11-05 00:03] Guard #99 begins shift\n"
+        "[1518-11-05 00:45] falls asleep\n"
+        "[1518-11-05 00:55] wakes up\n");
+
+    guard_report exampleReport = analyze_logs(parse_logs(example));
+    assert(exampleReport.strategy1 == 240 && "Error verifying puzzle #1");
+    assert(exampleReport.strategy2 == 4455 && "Error verifying puzzle #2");
+
+    guard_report report = analyze_logs(listLogs);
 
-    auto answer = 42;
+    // Puzzle #1
+    std::cout << "Answer to puzzle #1 : " << report.strategy1 << std::endl;
 
     // Puzzle #2
-    std::cout << "Answer puzzle #2: "<< answer << std::endl;
+    std::cout << "Answer puzzle #2: "<< report.strategy2 << std::endl;
 }
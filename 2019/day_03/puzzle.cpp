@@ -6,18 +6,20 @@
 
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <map>
 #include "myutils.h"
-#include <sstream>
 #include <algorithm>
 
 using namespace std;
 
 typedef struct
 {
-    int x;
-    int y;
+    long long x;
+    long long y;
 } point;
 
 std::ostream& operator<<(std::ostream& os, const point& p)
@@ -27,11 +29,13 @@ std::ostream& operator<<(std::ostream& os, const point& p)
         << p.y;
 }
 
-
+// Straight piece of a wire, with the number of steps walked before it
 typedef struct
 {
     point p1;
     point p2;
+    int wire;
+    long long stepsBefore;
 } line;
 
 std::ostream& operator<<(std::ostream& os, const line& l)
@@ -43,71 +47,31 @@ std::ostream& operator<<(std::ostream& os, const line& l)
 
 typedef vector<line> polyline;
 
-point find_intersection(
-    line l1,
-    line l2)
+// Steps from the start of the wire to p, p on l
+long long steps_to(const line& l, const point& p)
 {
-    point intersection = {0, 0};
-
-    int l1Xmin = std::min(l1.p1.x, l1.p2.x);
-    int l1Xmax = std::max(l1.p1.x, l1.p2.x);
-    int l2Xmin = std::min(l2.p1.x, l2.p2.x);
-    int l2Xmax = std::max(l2.p1.x, l2.p2.x);
-
-    int l1Ymin = std::min(l1.p1.y, l1.p2.y);
-    int l1Ymax = std::max(l1.p1.y, l1.p2.y);
-    int l2Ymin = std::min(l2.p1.y, l2.p2.y);
-    int l2Ymax = std::max(l2.p1.y, l2.p2.y);
-
-    if(
-        l1Xmin >= l2Xmin && l1Xmin <= l2Xmax &&
-        l1Xmax >= l2Xmin && l1Xmax <= l2Xmax &&
-        l2Ymin >= l1Ymin && l2Ymin <= l1Ymax &&
-        l2Ymax >= l1Ymin && l2Ymax <= l1Ymax
-    )
-    {
-        intersection = {l1Xmin, l2Ymin};
-    }
-    else if(
-        l2Xmin >= l1Xmin && l2Xmin <= l1Xmax &&
-        l2Xmax >= l1Xmin && l2Xmax <= l1Xmax &&
-        l1Ymin >= l2Ymin && l1Ymin <= l2Ymax &&
-        l1Ymax >= l2Ymin && l1Ymax <= l2Ymax
-    )
-    {
-        intersection = {l2Xmin, l1Ymin};
-    }
-    return intersection;
+    return l.stepsBefore + std::abs(p.x - l.p1.x) + std::abs(p.y - l.p1.y);
 }
 
-// Compute segment endpoints
-void compute_segments_endpoints(string dirWire, polyline& wire)
+// Compute segment endpoints and cumulative lengths from "R8,U5,..."
+void compute_segments_endpoints(string_view dirWire, int wireId, polyline& wire)
 {
-    // Make sure we start from a clean list
-    wire.clear();
-
-    // Extract list of token from each wire directions
-    std::istringstream ss(dirWire);
-
-    std::string token;
-
-    vector<string> lToken;
-    while (std::getline(ss, token, ','))
-    {
-        lToken.push_back(token);
-    }
-
-    // Compute wire endpoints
-    // Starting point
     point p1 = {0, 0};
-    point p2 = {0, 0};
+    long long steps = 0;
 
-    for(auto d : lToken)
+    size_t pos = 0;
+    while(pos < dirWire.size())
     {
-        char dir = d.front();
-        int offset = stoi(d.erase(0, 1));
+        char dir = dirWire[pos++];
 
+        long long offset = 0;
+        while(pos < dirWire.size() && dirWire[pos] >= '0' && dirWire[pos] <= '9')
+            offset = offset * 10 + (dirWire[pos++] - '0');
 
+        // Separator
+        pos++;
+
+        point p2 = p1;
         switch(dir)
         {
             case 'U':
@@ -122,112 +86,251 @@ void compute_segments_endpoints(string dirWire, polyline& wire)
             case 'R':
                 p2.x += offset;
                 break;
+            default:
+                continue;
         }
 
-        wire.push_back({p1, p2});
+        if(offset > 0)
+            wire.push_back({p1, p2, wireId, steps});
 
+        steps += offset;
         p1 = p2;
     }
 }
 
-vector<int>
-find_travel_distance(vector<point>& intersections, polyline& wire)
+// Crossing of two different wires
+typedef struct
+{
+    point p;
+    long long steps;    // Sum of the steps of both wires to p
+} crossing;
+
+// Shared points of the collinear segments of two different wires, the
+// origin excepted.
+//
+// Along an overlap, the distance to the origin is smallest at the point
+// nearest to it, and the sum of the steps is linear: smallest at an end.
+// So only these are reported, plus the neighbours of the origin when the
+// overlap goes through it: enough for both puzzles, whatever the length
+// of the overlap.
+void find_overlaps(const polyline& segments, vector<crossing>& crossings)
 {
-    vector<int> travelToIntersection;
+    // Segment on the line coord = c, from lo to hi along the line
+    struct span
+    {
+        bool horizontal;
+        long long c;
+        long long lo;
+        long long hi;
+        int segment;
+    };
+
+    vector<span> spans;
+    for(size_t i=0; i<segments.size(); i++)
+    {
+        const line& l = segments[i];
+
+        if(l.p1.y == l.p2.y)
+            spans.push_back({true, l.p1.y, std::min(l.p1.x, l.p2.x), std::max(l.p1.x, l.p2.x), (int)i});
+        else
+            spans.push_back({false, l.p1.x, std::min(l.p1.y, l.p2.y), std::max(l.p1.y, l.p2.y), (int)i});
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const span& a, const span& b)
+    {
+        if(a.horizontal != b.horizontal)
+            return a.horizontal < b.horizontal;
+        return a.c != b.c ? a.c < b.c : a.lo < b.lo;
+    });
 
-    for(auto inter : intersections)
+    // Shared points of the spans a and b, overlapping on [lo, hi]
+    auto report = [&](const span& a, const span& b, long long lo, long long hi)
     {
+        const line& la = segments[a.segment];
+        const line& lb = segments[b.segment];
+
+        long long candidates[] = {lo, hi, std::clamp(0LL, lo, hi), std::clamp(-1LL, lo, hi), std::clamp(1LL, lo, hi)};
+        std::sort(std::begin(candidates), std::end(candidates));
+        auto last = std::unique(std::begin(candidates), std::end(candidates));
+
+        for(auto t = std::begin(candidates); t != last; ++t)
+        {
+            point p = a.horizontal ? point{*t, a.c} : point{a.c, *t};
+            if(p.x == 0 && p.y == 0)
+                continue;
+
+            crossings.push_back({p, steps_to(la, p) + steps_to(lb, p)});
+        }
+    };
+
+    // Sweep of each line along its spans. The active spans are kept per
+    // wire, each wire's by end: a new span only goes through the spans of
+    // the other wires, all of which overlap it. A wire running back and
+    // forth over the line costs nothing, O(n log n + k) for k overlaps.
+    typedef multimap<long long, int> spansByEnd;
+
+    vector<spansByEnd::iterator> activeAt(spans.size());
+
+    for(size_t first=0, next; first<spans.size(); first=next)
+    {
+        next = first + 1;
+        while(next < spans.size() && spans[next].horizontal == spans[first].horizontal && spans[next].c == spans[first].c)
+            next++;
+
+        map<int, spansByEnd> active;          // Wire -> its active spans
+        multimap<long long, int> ends;        // All the active spans, by end
 
-        int travelWire = 0;
-        for(auto w : wire)
+        for(size_t i=first; i<next; i++)
         {
-            int curx = w.p1.x;
-            int cury = w.p1.y;
-            int incrx = 0;
-            int incry = 0;
-            int travelSegment = 0;
-            while(curx != w.p2.x || cury != w.p2.y)
+            const span& b = spans[i];
+            const int wire = segments[b.segment].wire;
+
+            // Spans ending before b, the endpoints count
+            while(!ends.empty() && ends.begin()->first < b.lo)
             {
-                if(w.p1.x < w.p2.x)
-                    curx++;
-                else if (w.p1.x > w.p2.x)
-                    curx--;
+                int k = ends.begin()->second;
+                ends.erase(ends.begin());
 
-                if(w.p1.y < w.p2.y)
-                    cury++;
-                else if (w.p1.y > w.p2.y)
-                    cury--;
+                auto w = active.find(segments[spans[k].segment].wire);
+                w->second.erase(activeAt[k]);
+                if(w->second.empty())
+                    active.erase(w);
+            }
 
-                travelSegment++;
+            for(auto& [otherWire, others] : active)
+            {
+                if(otherWire == wire)
+                    continue;
 
-                if(curx == inter.x && cury == inter.y)
-                {
-                    // Found an intersection
-                    travelToIntersection.push_back(travelWire + travelSegment);
-                    break;
-                }
+                for(auto& [end, k] : others)
+                    report(spans[k], b, b.lo, std::min(end, b.hi));
             }
 
-            travelWire += travelSegment;
+            activeAt[i] = active[wire].emplace(b.hi, (int)i);
+            ends.emplace(b.hi, (int)i);
         }
     }
-    return travelToIntersection;
 }
 
-
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data, polyline& wire1, polyline& wire2, vector<point>& intersections)
+// Every crossing of two different wires, the origin excepted.
+//
+// A vertical line sweeps the plane in x. The horizontal segments crossing
+// it are kept in an ordered map on their y: a vertical segment reports the
+// ones in its y range. O((n + m) log(n + m) + k) for n horizontal and m
+// vertical segments, any number of wires. The collinear overlaps are added
+// by find_overlaps().
+vector<crossing> find_crossings(const polyline& segments)
 {
-    // Make sure we start from a clean list
-    wire1.clear();
-    wire2.clear();
-    intersections.clear();
-
-    // Extract list of token from each wire directions
-    string dirWire1 = data[0];
-    string dirWire2 = data[1];
+    // At the same x: insert the horizontals, query with the verticals,
+    // then remove the horizontals (the endpoints count)
+    enum { INSERT = 0, QUERY = 1, REMOVE = 2 };
 
-    compute_segments_endpoints(dirWire1, wire1);
-    compute_segments_endpoints(dirWire2, wire2);
+    struct event
+    {
+        long long x;
+        int type;
+        int segment;
+    };
 
-    // Find intersections
-    for(auto l1 : wire1)
+    vector<event> events;
+    for(size_t i=0; i<segments.size(); i++)
     {
-        for(auto l2: wire2)
+        const line& l = segments[i];
+
+        if(l.p1.y == l.p2.y)
+        {
+            events.push_back({std::min(l.p1.x, l.p2.x), INSERT, (int)i});
+            events.push_back({std::max(l.p1.x, l.p2.x), REMOVE, (int)i});
+        }
+        else
         {
-            point intersection = find_intersection(l1, l2);
-            if(intersection.x != 0 || intersection.y != 0)
-                intersections.push_back(intersection);
+            events.push_back({l.p1.x, QUERY, (int)i});
         }
     }
 
-    // Find minimum distance (Manhattan distance)
-    int minDist = INT_MAX;
+    std::sort(events.begin(), events.end(), [](const event& a, const event& b)
+    {
+        return a.x != b.x ? a.x < b.x : a.type < b.type;
+    });
 
-    for(auto inter : intersections)
+    multimap<long long, int> active;
+    vector<multimap<long long, int>::iterator> activeAt(segments.size());
+    vector<crossing> crossings;
+
+    for(auto& e : events)
     {
-        minDist = std::min(minDist, abs(inter.x) + abs(inter.y));
-        // cout << "Min dist: " << minDist << endl;
+        const line& l = segments[e.segment];
+
+        switch(e.type)
+        {
+            case INSERT:
+                activeAt[e.segment] = active.emplace(l.p1.y, e.segment);
+                break;
+
+            case REMOVE:
+                active.erase(activeAt[e.segment]);
+                break;
+
+            case QUERY:
+            {
+                auto first = active.lower_bound(std::min(l.p1.y, l.p2.y));
+                auto last  = active.upper_bound(std::max(l.p1.y, l.p2.y));
+
+                for(auto it = first; it != last; ++it)
+                {
+                    const line& h = segments[it->second];
+                    if(h.wire == l.wire)
+                        continue;
+
+                    point p = {e.x, it->first};
+                    if(p.x == 0 && p.y == 0)
+                        continue;
+
+                    crossings.push_back({p, steps_to(l, p) + steps_to(h, p)});
+                }
+                break;
+            }
+        }
     }
 
+    find_overlaps(segments, crossings);
+
+    return crossings;
+}
+
+template <typename T>
+vector<crossing> wire_crossings(const T& data)
+{
+    polyline segments;
+    for(size_t w=0; w<data.size(); w++)
+        compute_segments_endpoints(data[w], w, segments);
+
+    return find_crossings(segments);
+}
+
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    // Find minimum distance (Manhattan distance)
+    long long minDist = LLONG_MAX;
+
+    for(auto& c : wire_crossings(data))
+        minDist = std::min(minDist, std::abs(c.p.x) + std::abs(c.p.y));
+
     return minDist;
 }
 
 // Solve puzzle #2
-int solve_puzzle2(polyline& wire1, polyline& wire2, vector<point>& intersections)
+template <typename T>
+long long solve_puzzle2(T data)
 {
-    // We march each wire until we reach a given intersection, then we compute the minimal marching length
-    vector<int> travelToIntersectionWire1 = find_travel_distance(intersections, wire1);
-    vector<int> travelToIntersectionWire2 = find_travel_distance(intersections, wire2);
+    // All the passes of both wires at a point are crossings: the smallest
+    // sum is the sum of the first arrivals
+    long long minTravelWire1Wire2 = LLONG_MAX;
 
-    int count = 0;
-    int minTravelWire1Wire2 = INT_MAX;
-    for(auto inter : intersections)
-    {
-        minTravelWire1Wire2 = std::min(minTravelWire1Wire2, travelToIntersectionWire1[count] + travelToIntersectionWire2[count]);
-        count++;
-    }
+    for(auto& c : wire_crossings(data))
+        minTravelWire1Wire2 = std::min(minTravelWire1Wire2, c.steps);
 
     return minTravelWire1Wire2;
 }
@@ -254,30 +357,24 @@ int main(int argc, char *argv[])
     //for(auto s : data)
     //    cout << s << endl;
 
-    polyline wire1;
-    polyline wire2;
-    vector<point> intersections;
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}, wire1, wire2, intersections) == 6 && "Error verifying puzzle #1");
-    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}, wire1, wire2, intersections) == 159 && "Error verifying puzzle #1");
-    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}, wire1, wire2, intersections) == 135 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}) == 6 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}) == 159 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}) == 135 && "Error verifying puzzle #1");
+    // Wires running along each other from the origin
+    assert(solve_puzzle1<vector<string>>({"R10,U5", "L2,R9,U2"}) == 1 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data, wire1, wire2, intersections) << std::endl;
+    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
-    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}, wire1, wire2, intersections) == 6 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 30 && "Error verifying puzzle #2");
-
-    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}, wire1, wire2, intersections) == 159 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 610 && "Error verifying puzzle #2");
-
-    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}, wire1, wire2, intersections) == 135 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 410 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}) == 30 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}) == 610 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}) == 410 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R10,U5", "L2,R9,U2"}) == 6 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
-    solve_puzzle1(data, wire1, wire2, intersections);
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(wire1, wire2, intersections) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;
 }
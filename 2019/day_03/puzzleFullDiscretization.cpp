@@ -6,10 +6,12 @@
 
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include "myutils.h"
-#include <sstream>
 #include <algorithm>
 
 using namespace std;
@@ -20,16 +22,6 @@ typedef struct
     int y;
 } point;
 
-bool operator==(const point &p1, const point& p2)
-{
-    return p1.x == p2.x && p1.y == p2.y;
-}
-
-bool operator!=(const point &p1, const point& p2)
-{
-    return p1.x != p2.x || p1.y != p2.y;
-}
-
 std::ostream& operator<<(std::ostream& os, const point& p)
 {
     return os << p.x
@@ -37,119 +29,116 @@ std::ostream& operator<<(std::ostream& os, const point& p)
         << p.y;
 }
 
-typedef struct
+// Both coordinates in one hash key
+unsigned long long point_key(const point& p)
 {
-    point p1;
-    point p2;
-} line;
-
-std::ostream& operator<<(std::ostream& os, const line& l)
-{
-    return os << l.p1
-        << " "
-        << l.p2;
+    return ((unsigned long long)(unsigned int)p.x << 32) | (unsigned int)p.y;
 }
 
-// Compute segment complete list of points
-void compute_segments_points(string dirWire, std::vector<point>& wire)
+// Walk every lattice point of the wire "R8,U5,...", visit(pt, steps)
+template <typename Visit>
+void walk_segments_points(string_view dirWire, Visit visit)
 {
-    // Make sure we start from a clean list
-    wire.clear();
-
-    // Extract list of token from each wire directions
-    std::istringstream ss(dirWire);
-
-    std::string token;
+    point pt = {0, 0};
+    long long steps = 0;
 
-    vector<string> lToken;
-    while (std::getline(ss, token, ','))
+    size_t pos = 0;
+    while(pos < dirWire.size())
     {
-        lToken.push_back(token);
-    }
+        char dir = dirWire[pos++];
 
-    // Compute wire endpoints
-    // Starting point
-    point pt = {0, 0};
-    wire.push_back(pt);
+        int offset = 0;
+        while(pos < dirWire.size() && dirWire[pos] >= '0' && dirWire[pos] <= '9')
+            offset = offset * 10 + (dirWire[pos++] - '0');
 
-    for(auto d : lToken)
-    {
-        char dir = d.front();
-        int offset = stoi(d.erase(0, 1));
+        // Separator
+        pos++;
+
+        int dx = 0;
+        int dy = 0;
+        switch(dir)
+        {
+            case 'U':
+                dy = 1;
+                break;
+            case 'D':
+                dy = -1;
+                break;
+            case 'L':
+                dx = -1;
+                break;
+            case 'R':
+                dx = 1;
+                break;
+        }
 
         for(int i=0; i<offset; i++)
         {
-            switch(dir)
-            {
-                case 'U':
-                    pt.y++;
-                    break;
-                case 'D':
-                    pt.y--;
-                    break;
-                case 'L':
-                    pt.x--;
-                    break;
-                case 'R':
-                    pt.x++;
-                    break;
-            }
-            wire.push_back(pt);
+            pt.x += dx;
+            pt.y += dy;
+            visit(pt, ++steps);
         }
     }
 }
 
-// Solve puzzle #1
+typedef struct
+{
+    long long minDist;
+    long long minSteps;
+} wires_result;
+
+// Every lattice point goes in a hash map with the fewest steps any of the
+// previous wires took to reach it, and the last wire that reached it.
+// The first visit of a point by another wire is an intersection.
+// O(total wire length), any number of wires.
 template <typename T>
-int solve_puzzle1(T data, vector<point>& wire1, vector<point>& wire2, vector<point>& intersections)
+wires_result walk_wires(const T& data)
 {
+    struct visit
+    {
+        long long steps;
+        int wire;
+    };
 
-    point orig({0, 0});
-
-    // Make sure we start from a clean list
-    wire1.clear();
-    wire2.clear();
-    intersections.clear();
+    unordered_map<unsigned long long, visit> visited;
+    wires_result result = {LLONG_MAX, LLONG_MAX};
 
-    // Extract list of endpoints from each wire directions
-    string dirWire1 = data[0];
-    string dirWire2 = data[1];
+    for(size_t w=0; w<data.size(); w++)
+    {
+        walk_segments_points(data[w], [&](const point& pt, long long steps)
+        {
+            if(pt.x == 0 && pt.y == 0)
+                return;
 
-    int minDist = INT_MAX;
+            auto [it, isNew] = visited.try_emplace(point_key(pt), visit{steps, (int)w});
+            if(isNew || it->second.wire == (int)w)
+                return;
 
-    compute_segments_points(dirWire1, wire1);
-    compute_segments_points(dirWire2, wire2);
+            result.minDist = std::min(result.minDist, (long long)std::abs(pt.x) + std::abs(pt.y));
+            result.minSteps = std::min(result.minSteps, it->second.steps + steps);
 
-    for(auto w1 : wire1)
-    {
-        for(auto w2 : wire2)
-        {
-            if(w1 == w2 && w1 != orig)
-                intersections.push_back(w1);
-        }
+            it->second.steps = std::min(it->second.steps, steps);
+            it->second.wire = w;
+        });
     }
 
-    // Find minimum distance (Manhattan distance)
-    for(auto inter : intersections)
-        minDist = std::min(minDist, abs(inter.x) + abs(inter.y));
+    return result;
+}
 
-    return minDist;
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    // Minimum Manhattan distance
+    return walk_wires(data).minDist;
 }
 
 // Solve puzzle #2
-int solve_puzzle2(vector<point>& wire1, vector<point>& wire2, vector<point>& intersections)
+template <typename T>
+long long solve_puzzle2(T data)
 {
-    int minTravelWire1Wire2 = INT_MAX;
-    for(auto inter : intersections)
-    {
-        std::vector<point>::iterator p1 = find(wire1.begin(), wire1.end(), inter);
-        std::vector<point>::iterator p2 = find(wire2.begin(), wire2.end(), inter);
-        int delta1 = p1 - wire1.begin();
-        int delta2 = p2 - wire2.begin();
-
-        minTravelWire1Wire2 = std::min(minTravelWire1Wire2, delta1 + delta2);
-    }
-    return minTravelWire1Wire2;
+    // A wire revisiting a point keeps its first, smallest, step count
+    return walk_wires(data).minSteps;
 }
 
 int main(int argc, char *argv[])
@@ -174,30 +163,21 @@ int main(int argc, char *argv[])
     //for(auto s : data)
     //    cout << s << endl;
 
-    vector<point> wire1;
-    vector<point> wire2;
-    vector<point> intersections;
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}, wire1, wire2, intersections)                                                          == 6   && "Error verifying puzzle #1");
-    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}, wire1, wire2, intersections)               == 159 && "Error verifying puzzle #1");
-    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}, wire1, wire2, intersections) == 135 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}) == 6 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}) == 159 && "Error verifying puzzle #1");
+    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}) == 135 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data, wire1, wire2, intersections) << std::endl;
+    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
-    assert(solve_puzzle1<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}, wire1, wire2, intersections) == 6 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 30 && "Error verifying puzzle #2");
-
-    assert(solve_puzzle1<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}, wire1, wire2, intersections) == 159 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 610 && "Error verifying puzzle #2");
-
-    assert(solve_puzzle1<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}, wire1, wire2, intersections) == 135 && "Error verifying puzzle #1");
-    assert(solve_puzzle2(wire1, wire2, intersections) == 410 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R8,U5,L5,D3", "U7,R6,D4,L4"}) == 30 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R75,D30,R83,U83,L12,D49,R71,U7,L72", "U62,R66,U55,R34,D71,R55,D58,R83"}) == 610 && "Error verifying puzzle #2");
+    assert(solve_puzzle2<vector<string>>({"R98,U47,R26,D63,R33,U87,L62,D20,R33,U53,R51", "U98,R91,D20,R16,D67,R40,U7,R15,U6,R7"}) == 410 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
-    solve_puzzle1(data, wire1, wire2, intersections);
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(wire1, wire2, intersections) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;
 }
@@ -7,87 +7,142 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
 #include "myutils.h"
 
 using namespace std;
 
-// Solve puzzle #1
-int solve_puzzle1(int nMin, int nMax)
+// Which runs of equal digits make a password valid
+enum class pairRule
+{
+    SOME_PAIR,      // a run of 2 or more
+    EXACT_PAIR      // a run of exactly 2
+};
+
+// Count the passwords of [nMin, nMax] with digit DP: digits never decrease,
+// and some run of equal digits satisfies the rule. Numbers up to 18 digits,
+// in microseconds whatever the range.
+//
+// State after a prefix: last digit, length of its run (capped at 3), and
+// whether an earlier run already satisfied the rule.
+class password_counter
 {
-    int counter = 0;
-    while(nMin <= nMax)
+    static constexpr int MAX_DIGITS = 18;
+
+    pairRule rule_;
+
+    // completions_[remaining][last][run][found], -1 when not computed yet
+    long long completions_[MAX_DIGITS + 1][10][4][2];
+
+    bool qualifies(int run) const
     {
-        int d1 = nMin/100000 % 10;
-        int d2 = nMin/10000 % 10;
-        int d3 = nMin/1000 % 10;
-        int d4 = nMin/100 % 10;
-        int d5 = nMin/10 % 10;
-        int d6 = nMin % 10;
-
-        //cout << d1 << " : " << d2  << " : " << d3  << " : " << d4  << " : " << d5  << " : " << d6 << endl;
-
-        if (
-            (d1 == d2 || d2 == d3 || d3 == d4 || d4 == d5 || d5 == d6) &&
-            ( d1 <= d2 && d2 <= d3 && d3 <= d4 && d4 <= d5 && d5 <= d6)
-        )
+        return rule_ == pairRule::SOME_PAIR ? run >= 2 : run == 2;
+    }
+
+    // Ways to append 'remaining' digits
+    long long completions(int remaining, int last, int run, bool found)
+    {
+        if (remaining == 0)
+            return (found || qualifies(run)) ? 1 : 0;
+
+        long long& memo = completions_[remaining][last][run][found];
+        if (memo >= 0)
+            return memo;
+
+        long long n = 0;
+        for (int d=last; d<=9; d++)
         {
-            counter++;
+            if (d == last)
+                n += completions(remaining - 1, d, std::min(run + 1, 3), found);
+            else
+                n += completions(remaining - 1, d, 1, found || qualifies(run));
         }
-
-        nMin++;
+        return memo = n;
     }
 
-    return counter;;
-}
+    // Valid passwords in [1, n]
+    long long count_up_to(long long n)
+    {
+        if (n <= 0)
+            return 0;
 
-// Solve puzzle #2
-int solve_puzzle2(int nMin, int nMax)
-{
-    //cout << "nMin: " << nMin << endl;
-    //cout << "nMax: " << nMax << endl;
+        std::vector<int> digits;
+        for (long long m = n; m > 0; m /= 10)
+            digits.push_back(m % 10);
+        std::reverse(digits.begin(), digits.end());
 
-    int counter = 0;
-    do
-    {
-        int d1 = nMin/100000 % 10;
-        int d2 = nMin/10000 % 10;
-        int d3 = nMin/1000 % 10;
-        int d4 = nMin/100 % 10;
-        int d5 = nMin/10 % 10;
-        int d6 = nMin % 10;
-
-        // cout << d1 << " : " << d2  << " : " << d3  << " : " << d4  << " : " << d5  << " : " << d6 << endl;
-
-        if (
-            (d1 == d2 || d2 == d3 || d3 == d4 || d4 == d5 || d5 == d6) &&
-            ( d1 <= d2 && d2 <= d3 && d3 <= d4 && d4 <= d5 && d5 <= d6)
-        )
+        const int length = digits.size();
+        long long total = 0;
+
+        // Shorter numbers: any first digit 1..9
+        for (int l=1; l<length; l++)
+            for (int first=1; first<=9; first++)
+                total += completions(l - 1, first, 1, false);
+
+        // Same length: digits below n's digit, then follow n
+        int last = 0;
+        int run = 0;
+        bool found = false;
+
+        for (int i=0; i<length; i++)
         {
-            // This is ugly as hell, and will never scale....
-            // Need to find a better way than this exhaustive craziness
-            if (
-                (!(d1 == d2 && d2 == d3)                        || (d4 == d5 && d4 != d1) || (d5 == d6 && d5 != d1)) &&
-                (!(d2 == d3 && d3 == d4)                        || (d5 == d6 && d5 != d2 ))                          &&
-                (!(d3 == d4 && d4 == d5)                        || (d1 == d2 && d1 != d3 ))                          &&
-                (!(d4 == d5 && d5 == d6)                        || (d1 == d2 && d1 != d4) || (d2 == d3 && d2 != d4)) &&
-                (!(d1 == d2 && d2 == d3 && d3 == d4)            || (d5 == d6 && d5 != d1))                           &&
-                (!(d2 == d3 && d3 == d4 && d4 == d5)                         )                                       &&
-                (!(d3 == d4 && d4 == d5 && d5 == d6)            || (d1 == d2 && d2 != d3))                           &&
-                (!(d1 == d2 && d2 == d3 && d3 == d4 && d4 == d5))                                                    &&
-                (!(d2 == d3 && d3 == d4 && d4 == d5 && d5 == d6))                                                    &&
-                (!(d1 == d2 && d2 == d3 && d4 == d5 && d5 == d6))
-            )
+            for (int d=std::max(last, i == 0 ? 1 : 0); d<digits[i]; d++)
             {
-                //cout << nMin << endl;
-                counter++;
+                if (d == last)
+                    total += completions(length - i - 1, d, std::min(run + 1, 3), found);
+                else
+                    total += completions(length - i - 1, d, 1, found || qualifies(run));
             }
+
+            // n itself decreases here: no more candidates
+            if (digits[i] < last)
+                return total;
+
+            if (digits[i] == last)
+            {
+                run = std::min(run + 1, 3);
+            }
+            else
+            {
+                found = found || qualifies(run);
+                run = 1;
+            }
+            last = digits[i];
         }
 
-        nMin++;
+        // n itself
+        if (found || qualifies(run))
+            total++;
+
+        return total;
+    }
+
+public:
+
+    explicit password_counter(pairRule rule)
+        : rule_(rule)
+    {
+        std::fill(&completions_[0][0][0][0], &completions_[0][0][0][0] + sizeof(completions_) / sizeof(long long), -1);
     }
-    while (nMin <= nMax);
 
-    return counter;;
+    long long count(long long nMin, long long nMax)
+    {
+        if (nMax < nMin)
+            return 0;
+        return count_up_to(nMax) - count_up_to(nMin - 1);
+    }
+};
+
+// Solve puzzle #1
+long long solve_puzzle1(long long nMin, long long nMax)
+{
+    return password_counter(pairRule::SOME_PAIR).count(nMin, nMax);
+}
+
+// Solve puzzle #2
+long long solve_puzzle2(long long nMin, long long nMax)
+{
+    return password_counter(pairRule::EXACT_PAIR).count(nMin, nMax);
 }
 
 int main(int argc, char *argv[])
@@ -108,17 +163,17 @@ int main(int argc, char *argv[])
     }
 
     // Reading the data
-    auto data = myutils::read_file_csv<int, std::vector<int> >(filename, false, '-');
+    auto data = myutils::read_file_csv<long long, std::vector<long long> >(filename, false, '-');
 
     cout << "Range: " << data[0] << "-" << data[1] << endl;;
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    const auto example1 = 1;
     assert(solve_puzzle1(111111, 111111)   == 1    && "Error verifying puzzle #1");
     assert(solve_puzzle1(223450, 223450)   == 0    && "Error verifying puzzle #1");
     assert(solve_puzzle1(123789, 123789)   == 0    && "Error verifying puzzle #1");
     assert(solve_puzzle1(data[0], data[1]) == 1864 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(1, 999999999999999999) == 4686313 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
     std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data[0], data[1]) << std::endl;
@@ -130,6 +185,7 @@ int main(int argc, char *argv[])
     assert(solve_puzzle2(111122, 111122) == 1      && "Error verifying puzzle #2");
     assert(solve_puzzle2(222555, 222555) == 0      && "Error verifying puzzle #2");
     assert(solve_puzzle2(data[0], data[1]) == 1258 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(1, 999999999999999999) == 3669985 && "Error verifying puzzle #2");
 
     // Solve puzzle #2
     std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data[0], data[1]) << std::endl;
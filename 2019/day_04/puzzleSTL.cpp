@@ -8,84 +8,85 @@
 #include <cassert>
 #include <vector>
 #include "myutils.h"
-#include <algorithm>    // std::adjacent_find
+#include <algorithm>
+#include <numeric>
+#include <string>
 
 using namespace std;
 
-// Solve puzzle #1
-
-int solve_puzzle1(int nMin, int nMax)
+// Lengths of the runs of equal digits
+vector<int> run_lengths(const vector<int>& digits)
 {
-    int counter = 0;
+    vector<int> runs;
 
-    while(nMin <= nMax)
+    for (auto it = digits.begin(); it != digits.end(); )
     {
-        string snMin = to_string(nMin);
-
-        if (
-            is_sorted(snMin.begin(), snMin.end()) &&                 // ascending order
-            adjacent_find(snMin.begin(), snMin.end()) != snMin.end() // at least one adjacent pair
-        )
-        {
-            counter++;
-        }
-        nMin++;
+        auto next = find_if(it, digits.end(), [&](int d) { return d != *it; });
+        runs.push_back(distance(it, next));
+        it = next;
     }
-
-    return counter;;
+    return runs;
 }
 
-// Solve puzzle #2
-int solve_puzzle2(int nMin, int nMax)
+// Count the passwords of [nMin, nMax] by enumerating only the digit
+// sequences that never decrease: digits 1..9 only, as a leading zero would
+// have to be followed by zeros, so C(L+8, 8) of them for L digits (3003 for
+// 6 digits, 4686824 up to 18 digits), instead of every integer of the range.
+// isValid(runs) checks the pair rule on the run lengths.
+template <typename F>
+long long count_passwords(long long nMin, long long nMax, F isValid)
 {
-    int counter = 0;
+    const int minLength = to_string(max(nMin, 1LL)).size();
+    const int maxLength = to_string(max(nMax, 1LL)).size();
+
+    long long counter = 0;
 
-    while(nMin <= nMax)
+    for (int length = minLength; length <= maxLength; length++)
     {
-        string snMin = to_string(nMin);
+        // Smallest sequence: 11...1
+        vector<int> digits(length, 1);
 
-        if(is_sorted(snMin.begin(), snMin.end())) // Ascending order
+        while (true)
         {
-            string::iterator startBlockOf2;
-            string::iterator startBlockOf345;
-
-            bool foundBlock345 = false;
-
-            // Remove all group of 3, 4, 5 consecutive characters
-            do
-            {
-                foundBlock345 = false;
-
-                // Start by finding the next group of 2 (instead of iterating over all possible digits
-                startBlockOf2 = adjacent_find(snMin.begin(), snMin.end());
-
-                if(startBlockOf2 != snMin.end())
-                {
-                    for (int n : {5, 4, 3})  // Remove largest block first: 5, 4 and 3
-                    {
-                        startBlockOf345 = search_n(snMin.begin(), snMin.end(), n, *startBlockOf2);
-
-                        if(startBlockOf345 != snMin.end())
-                        {
-                            foundBlock345 = true;
-                            snMin.erase(startBlockOf345, startBlockOf345 + n);
-                        }
-                    }
-                }
-            }
-            while(foundBlock345);
-
-            // Only block of 2 consecutives characters shall remain
-
-            if (adjacent_find(snMin.begin(), snMin.end()) != snMin.end()) // at least one adjacent pair must remains
-            {
+            long long value = accumulate(digits.begin(), digits.end(), 0LL,
+                [](long long v, int d) { return v * 10 + d; });
+
+            if (value > nMax)
+                break;
+
+            if (value >= nMin && isValid(run_lengths(digits)))
                 counter++;
-            }
+
+            // Next non-decreasing sequence: bump the rightmost digit below 9,
+            // and copy it to everything after it
+            auto it = find_if(digits.rbegin(), digits.rend(), [](int d) { return d < 9; });
+            if (it == digits.rend())
+                break;
+
+            int bumped = ++(*it);
+            fill(it.base(), digits.end(), bumped);
         }
-        nMin++;  // next in sequence
     }
 
-    return counter;;
+    return counter;
+}
+
+// Solve puzzle #1
+long long solve_puzzle1(long long nMin, long long nMax)
+{
+    return count_passwords(nMin, nMax, [](const vector<int>& runs)
+    {
+        return any_of(runs.begin(), runs.end(), [](int r) { return r >= 2; });
+    });
+}
+
+// Solve puzzle #2
+long long solve_puzzle2(long long nMin, long long nMax)
+{
+    return count_passwords(nMin, nMax, [](const vector<int>& runs)
+    {
+        return find(runs.begin(), runs.end(), 2) != runs.end();
+    });
 }
 
 int main(int argc, char *argv[])
@@ -106,7 +107,7 @@ int main(int argc, char *argv[])
     }
 
     // Reading the data
-    auto data = myutils::read_file_csv<int, std::vector<int> >(filename, false, '-');
+    auto data = myutils::read_file_csv<long long, std::vector<long long> >(filename, false, '-');
 
     cout << "Range: " << data[0] << "-" << data[1] << endl;;
 
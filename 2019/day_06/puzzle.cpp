@@ -8,152 +8,192 @@
 #include <cassert>
 #include <vector>
 #include "myutils.h"
+#include "mygraph.h"
 
-#include <sstream>
-#include <map>
-#include <set>
+#include <string_view>
 
 using namespace std;
 
-typedef map<string, string> Orbit;
-
-template <typename T>
-Orbit constructOrbits(T data)
+// Orbit tree: the bodies are interned to dense ids, parent[u] is the body u
+// orbits around (-1 for a root, normally COM).
+//
+// The depths are computed in one pass in topological order. The lowest
+// common ancestor uses binary lifting: up[k][u] is the 2^k-th ancestor of
+// u, so a transfer distance costs O(log depth) whatever the tree size.
+class orbit_tree
 {
-    Orbit orbits;
+    myutils::graph::interner names_;
+
+    vector<int> parent_;
+    vector<int> depth_;
 
-    for(auto d : data)
+    // Binary lifting table, level k at up_[k*n + u]. A root is its own ancestor.
+    vector<int> up_;
+    int nbrLevels_;
+
+    int ancestor(int k, int u) const
     {
-        stringstream ss (d);
-        string item;
-        char delim = ')';
+        return up_[(size_t)k * parent_.size() + u];
+    }
 
-        string object;
-        string orbitsAround;
+public:
+
+    // Lines "A)B": B orbits around A
+    template <typename T>
+    explicit orbit_tree(const T& data)
+    {
+        vector<pair<int, int>> orbits;
+        orbits.reserve(data.size());
 
-        while (getline (ss, item, delim))
+        for(auto& d : data)
         {
-            if(orbitsAround.empty())
-                orbitsAround = item;
-            else
-                object = item;
+            string_view line(d);
+            auto sep = line.find(')');
+
+            int center = names_.id(line.substr(0, sep));
+            int object = names_.id(line.substr(sep + 1));
+            orbits.emplace_back(center, object);
         }
-        orbits.insert ( std::pair<string,string>(object,orbitsAround) );
-    }
-    return orbits;
-}
 
+        int n = names_.size();
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data)
-{
-    // Construct orbits map
-    Orbit orbits = constructOrbits(data);
+        parent_.assign(n, -1);
+        myutils::graph::csr_builder<int> edges;
+        for(auto& [center, object] : orbits)
+        {
+            assert(parent_[object] < 0 && "A body orbits around two bodies");
+            parent_[object] = center;
+            edges.add_edge(center, object);
+        }
 
-    // Compute total number of direct and indirect orbits
-    int nbrTotOrbits = 0;
-    for(auto orbit = orbits.begin(); orbit != orbits.end(); orbit++)
-    {
-        auto curOrbit = orbit;
+        // Depths, parents first
+        auto order = myutils::graph::topological_sort(edges.build(n));
+        assert((int)order.size() == n && "Orbits are cyclic");
+
+        depth_.assign(n, 0);
+        int maxDepth = 0;
+        for(int u : order)
+        {
+            if(parent_[u] >= 0)
+                depth_[u] = depth_[parent_[u]] + 1;
+
+            maxDepth = std::max(maxDepth, depth_[u]);
+        }
+
+        // Binary lifting table
+        nbrLevels_ = 1;
+        while((1 << nbrLevels_) <= maxDepth)
+            nbrLevels_++;
 
-        nbrTotOrbits++;
+        up_.resize((size_t)nbrLevels_ * n);
+        for(int u=0; u<n; u++)
+            up_[u] = parent_[u] < 0 ? u : parent_[u];
 
-        while(curOrbit->second != "COM")
+        for(int k=1; k<nbrLevels_; k++)
         {
-            nbrTotOrbits++;
-            curOrbit = orbits.find(curOrbit->second);
+            const int* prev = &up_[(size_t)(k - 1) * n];
+            int* cur = &up_[(size_t)k * n];
+
+            for(int u=0; u<n; u++)
+                cur[u] = prev[prev[u]];
         }
     }
 
-    return nbrTotOrbits;
-}
-
-// Solve puzzle #2
-template <typename T>
-int solve_puzzle2(T data)
-{
-    // Construct orbits map
-    Orbit orbits = constructOrbits(data);
+    int size() const
+    {
+        return parent_.size();
+    }
 
-    // Find current orbit for YOU
-    auto YOU_orbit = orbits.find("YOU");
-    auto SAN_orbit = orbits.find("SAN");
+    // Id of a body, -1 if unknown
+    int find(string_view name) const
+    {
+        return names_.find(name);
+    }
 
-#if 1
-    // This version is using sets, and set operations: intersection snd difference
-    set<string> pathToYOU;
-    set<string> pathToSAN;
+    int parent(int u) const
+    {
+        return parent_[u];
+    }
 
-    // Compute path to YOU
-    while(YOU_orbit->second != "COM")
+    // Direct and indirect orbits of u
+    int depth(int u) const
     {
-        pathToYOU.insert(YOU_orbit->second);
-        YOU_orbit = orbits.find(YOU_orbit->second);
+        return depth_[u];
     }
 
-    // Compute path to SAN
-    while(SAN_orbit->second != "COM")
+    // Total number of direct and indirect orbits
+    long long total_orbits() const
     {
-        pathToSAN.insert(SAN_orbit->second);
-        SAN_orbit = orbits.find(SAN_orbit->second);
+        long long total = 0;
+        for(int d : depth_)
+            total += d;
+
+        return total;
     }
 
-    set<string> commonPath;
-    set<string> transferYOU;
-    set<string> transferSAN;
-
-    // Find common path
-    set_intersection(
-        pathToYOU.begin(), pathToYOU.end(),
-        pathToSAN.begin(), pathToSAN.end(),
-        inserter(commonPath, commonPath.begin())
-    );
-
-    // Find exclusive path to YOU
-    set_difference(
-        pathToYOU.begin(), pathToYOU.end(),
-        commonPath.begin(), commonPath.end(),
-        inserter(transferYOU, transferYOU.begin())
-    );
-
-    // Find exclusive path to SAN
-    set_difference(
-        pathToSAN.begin(), pathToSAN.end(),
-        commonPath.begin(), commonPath.end(),
-        inserter(transferSAN, transferSAN.begin())
-    );
-
-    return transferYOU.size() + transferSAN.size();
-
-#else
-    // This version is using iterative backwalks through the orbits map to find a common orbit
-    int YOU_transfers = 0;
-    int SAN_transfers = 0;
-
-    while(YOU_orbit->second != SAN_orbit->second && YOU_orbit->second != "COM")
+    // Lowest common ancestor, -1 if u and v are not in the same tree
+    int lca(int u, int v) const
     {
-        YOU_orbit = orbits.find(YOU_orbit->second);
-        YOU_transfers++;
+        if(depth_[u] < depth_[v])
+            std::swap(u, v);
 
-        // Go back from SAN_orbit toward COM. If we find a match with YOU_orbit, jackpot!
-        // Otherwise, we change YOU_orbit, and start over.
-        SAN_transfers = 0;
-        SAN_orbit = orbits.find("SAN");
+        // Same depth
+        int diff = depth_[u] - depth_[v];
+        for(int k=0; diff; k++, diff >>= 1)
+            if(diff & 1)
+                u = ancestor(k, u);
 
-        while(SAN_orbit->second != "COM")
-        {
-            SAN_orbit = orbits.find(SAN_orbit->second);
-            SAN_transfers++;
+        if(u == v)
+            return u;
 
-            if (YOU_orbit->second == SAN_orbit->second)
+        for(int k=nbrLevels_-1; k>=0; k--)
+        {
+            if(ancestor(k, u) != ancestor(k, v))
             {
-                break;
+                u = ancestor(k, u);
+                v = ancestor(k, v);
             }
         }
+
+        return parent_[u] == parent_[v] ? parent_[u] : -1;
     }
-    return YOU_transfers + SAN_transfers;
-#endif
+
+    // Number of edges between u and v, -1 if not connected
+    int distance(int u, int v) const
+    {
+        int a = lca(u, v);
+        return a < 0 ? -1 : depth_[u] + depth_[v] - 2 * depth_[a];
+    }
+
+    // Orbital transfers to move from the body a orbits around to the one
+    // b orbits around, -1 if a or b is unknown or orbits around nothing
+    int transfers(int a, int b) const
+    {
+        if(a < 0 || b < 0 || parent_[a] < 0 || parent_[b] < 0)
+            return -1;
+
+        return distance(parent_[a], parent_[b]);
+    }
+};
+
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data)
+{
+    // Total number of direct and indirect orbits
+    return orbit_tree(data).total_orbits();
+}
+
+// Solve puzzle #2
+template <typename T>
+int solve_puzzle2(T data)
+{
+    orbit_tree orbits(data);
+
+    int nbrTransfers = orbits.transfers(orbits.find("YOU"), orbits.find("SAN"));
+    assert(nbrTransfers >= 0 && "YOU and SAN must orbit around bodies of the same tree");
+
+    return nbrTransfers;
 }
 
 int main(int argc, char *argv[])
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <vector>
 #include <stack>
 #include "myutils.h"
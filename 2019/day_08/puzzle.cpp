@@ -6,149 +6,195 @@
 
 #include <iostream>
 #include <cassert>
-#include <array>
 #include <vector>
+#include <cstring>
+#include <string_view>
+#include <climits>
 #include "myutils.h"
 
 using namespace std;
 
 const int imageWidth = 25;
 const int imageHeight = 6;
-const int nbpPixPerLayer = imageWidth * imageHeight;
 
-typedef array<int, nbpPixPerLayer> imageLayer;
+const char blackPixel = '0';
+const char whitePixel = '1';
+const char transparentPixel = '2';
 
-template <typename T>
-void
-extractImageLayers(T data, vector<imageLayer>& image)
+typedef struct
 {
-    int nbrLayers = data[0].size() / (imageWidth*imageHeight);
+    long long zeros;
+    long long ones;
+    long long twos;
+} layerCounts;
 
-    image.resize(nbrLayers);
-    int nLayer = 0;
-    for(int k=0; k<data[0].size();)
-    {
-        for(int i = 0; i<nbpPixPerLayer; i++)
-        {
-            // Convert ASCII to integer
-            image[nLayer][i] = data[0][k++] - '0';
-        }
-        nLayer++;
-    }
+// Decoder working on the raw digits, in place: layer l is the slice
+// [l * width * height, (l + 1) * width * height) of the input.
+//
+// The pixels are compared 32 at a time in vector registers: one pass per
+// layer counts the 0, 1 and 2 digits together, and the compositing blends
+// the layers front to back, 32 pixels at a time, until none of them is
+// transparent anymore.
+class image_decoder
+{
+    static constexpr int LANES = 32;
+    typedef signed char bytes __attribute__((vector_size(LANES)));
+    typedef unsigned char counters __attribute__((vector_size(LANES)));
 
-#if 0
-    cout << "nbrLayers: " << nbrLayers << endl;
+    string_view digits_;
+    long long layerSize_;
+    long long nbrLayers_;
 
-    for(auto layer : image)
+    // The vectors are passed by reference: by value, their ABI depends on
+    // the instruction set enabled (-Wpsabi).
+
+    // n bytes from p, the missing lanes set to fill
+    static void load(bytes& v, const char* p, int n = LANES, char fill = blackPixel)
     {
-        for(auto p : layer)
-        {
-            cout << p;
-        }
-        cout << endl << endl;
+        if(n < LANES)
+            memset(&v, fill, sizeof(v));
+        memcpy(&v, p, n);
     }
-#endif
-    return;
-}
 
-vector<int>
-calcNbrPixels(vector<imageLayer> image, int pixValue)
-{
-    vector<int> pixNbrPerLayer;
+    static long long sum(const counters& c)
+    {
+        long long n = 0;
+        for(int i=0; i<LANES; i++)
+            n += c[i];
+        return n;
+    }
 
-    for(auto layer : image)
+    static bool any(const bytes& m)
     {
-        int sum = count(layer.begin(), layer.end(), pixValue);
-        pixNbrPerLayer.push_back(sum);
+        unsigned long long w[LANES / 8];
+        memcpy(w, &m, sizeof(w));
+
+        unsigned long long r = 0;
+        for(auto x : w)
+            r |= x;
+        return r != 0;
     }
 
-#if 0
-    cout << "nbr pixvalue: " << pixValue << endl;
-    for(auto n : pixNbrPerLayer)
-        cout << n << " : " ;
-    cout << endl;
-#endif
+public:
 
-    return pixNbrPerLayer;
-}
+    image_decoder(string_view digits, int width, int height)
+        : digits_(digits),
+          layerSize_((long long)width * height),
+          nbrLayers_(digits.size() / layerSize_)
+    {
+        assert(digits.size() % layerSize_ == 0 && "Incomplete image layer");
+    }
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data)
-{
-    // Extract layers
-    vector<imageLayer> image;
-    extractImageLayers(data, image);
+    long long nbr_layers() const
+    {
+        return nbrLayers_;
+    }
 
-    vector<int> nbrZeros = calcNbrPixels(image, 0);
-    vector<int> nbrOnes = calcNbrPixels(image, 1);
-    vector<int> nbrTwos = calcNbrPixels(image, 2);
+    // Number of 0, 1 and 2 digits of a layer, in one pass
+    layerCounts counts(long long layer) const
+    {
+        const char* p = digits_.data() + layer * layerSize_;
+        const long long size = layerSize_;
 
-    // Find layer with minimal number of zeros
-    int indexMinZero = distance(nbrZeros.begin(), std::min_element(nbrZeros.begin(), nbrZeros.end()));
+        layerCounts c = {0, 0, 0};
+        long long i = 0;
 
-    // Return answer
-    return nbrOnes[indexMinZero] * nbrTwos[indexMinZero];
-}
+        while(i + LANES <= size)
+        {
+            // 8-bit counters, flushed before they can wrap
+            counters zeros = {};
+            counters ones = {};
+            counters twos = {};
 
-// Solve puzzle #2
-template <typename T>
-string solve_puzzle2(T data)
-{
-    // Extract layers
-    vector<imageLayer> image;
-    extractImageLayers(data, image);
+            for(int k=0; k<UCHAR_MAX && i + LANES <= size; k++, i += LANES)
+            {
+                bytes v;
+                load(v, p + i);
+                zeros -= (counters)(v == '0');
+                ones  -= (counters)(v == '1');
+                twos  -= (counters)(v == '2');
+            }
 
-    const int transparentPixel = 2;
+            c.zeros += sum(zeros);
+            c.ones  += sum(ones);
+            c.twos  += sum(twos);
+        }
 
-#if defined BACKWARD_VERSION
-    // Use reverse iterator for handling layers from bottom to top (backward)
-    vector<imageLayer>::reverse_iterator rit = image.rbegin();
+        for(; i<size; i++)
+        {
+            c.zeros += p[i] == '0';
+            c.ones  += p[i] == '1';
+            c.twos  += p[i] == '2';
+        }
 
-    imageLayer renderedImage = *rit;
+        return c;
+    }
 
-    // Backward stepping through all layers, handling transparent pixels
-    for (; rit!= image.rend(); ++rit)
+    // Counts of the layer with the fewest 0 digits
+    layerCounts fewest_zeros() const
     {
-        for(int i=0; i<nbpPixPerLayer; i++)
+        layerCounts best = {LLONG_MAX, 0, 0};
+
+        for(long long l=0; l<nbrLayers_; l++)
         {
-            int pixel = (*rit)[i];
-            if(pixel != transparentPixel)
-            {
-                renderedImage[i] = pixel;
-            }
+            layerCounts c = counts(l);
+            if(c.zeros < best.zeros)
+                best = c;
         }
-    }
 
-#else  // Forward version, more efficient since we only analyze transparent pixels
-    int nbrLayers = data[0].size() / (imageWidth*imageHeight);
-    imageLayer renderedImage = image[0];
+        return best;
+    }
 
-    // Forward stepping through all layers, handling only transparent pixels
-    for(int p = 0; p<nbpPixPerLayer; p++)
+    // Visible image: for every pixel, the first layer where it is not
+    // transparent
+    string composite() const
     {
-        if(renderedImage[p] == transparentPixel)
+        string image(layerSize_, transparentPixel);
+
+        for(long long p=0; p<layerSize_; p+=LANES)
         {
-            // Dig down through layers, searching for first not transparent pixel
-            for (int l = 1; l< nbrLayers; l++)
+            int n = min<long long>(LANES, layerSize_ - p);
+
+            // The missing lanes are opaque
+            bytes visible;
+            load(visible, digits_.data() + p, n);
+            bytes transparent = visible == transparentPixel;
+
+            for(long long l=1; l<nbrLayers_ && any(transparent); l++)
             {
-                if(image[l][p] != transparentPixel)
-                {
-                    renderedImage[p] = image[l][p];
-                    break;
-                }
+                bytes v;
+                load(v, digits_.data() + l * layerSize_ + p, n);
+                visible = transparent ? v : visible;
+                transparent = visible == transparentPixel;
             }
+
+            memcpy(&image[p], &visible, n);
         }
+
+        return image;
     }
+};
 
-#endif
+// Solve puzzle #1
+template <typename T>
+long long solve_puzzle1(T data, int width = imageWidth, int height = imageHeight)
+{
+    layerCounts c = image_decoder(data[0], width, height).fewest_zeros();
+
+    return c.ones * c.twos;
+}
+
+// Solve puzzle #2
+template <typename T>
+string solve_puzzle2(T data, int width = imageWidth, int height = imageHeight)
+{
+    string renderedImage = image_decoder(data[0], width, height).composite();
 
     // Render image using dots and spaces
-    int k = 0;
-    for(int i=0; i<nbpPixPerLayer; i++)
+    for(size_t i=0; i<renderedImage.size(); i++)
     {
-        cout << (i % imageWidth == 0 ? "\n" : "");
-        cout << (renderedImage[k++] == 1 ? "."  : " ");
+        cout << (i % width == 0 ? "\n" : "");
+        cout << (renderedImage[i] == whitePixel ? "."  : " ");
     }
     cout << endl;
 
@@ -177,6 +223,7 @@ int main(int argc, char *argv[])
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
+    assert(solve_puzzle1(vector<string>{"123456789012"}, 3, 2) == 1 && "Error verifying puzzle #1");
     assert(solve_puzzle1(data) == 1716 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
@@ -184,6 +231,7 @@ int main(int argc, char *argv[])
 
     // --------- Puzzle #2 ---------
     // Verify puzzle2 examples
+    assert(image_decoder("0222112222120000", 2, 2).composite() == "0110" && "Error verifying puzzle #2");
     assert(solve_puzzle2(data) == "KFABY" && "Error verifying puzzle #2");
 
     // Solve puzzle #2
@@ -7,145 +7,280 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
-#include <set>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
 #include "myutils.h"
-#include <cfloat>
-#include <map>
-#include <set>
 
 using namespace std;
 
 typedef myutils::point coords;
 
 void
-extractAsteroids(vector<string>& data, vector<coords>& asteroids)
+extractAsteroids(const vector<string>& data, vector<coords>& asteroids)
 {
-    int x = 0;
     int y = 0;
 
-    for(auto line : data)
+    for(auto& line : data)
     {
-        x = 0;
+        int x = 0;
         for(auto c : line)
         {
             if(c == '#')
-            {
-                coords coord(x, y);
-                asteroids.push_back(coord);
-            }
+                asteroids.emplace_back(x, y);
             x++;
         }
         y++;
     }
+}
+
+// Binary gcd, a and b not both 0
+int binary_gcd(int a, int b)
+{
+    unsigned u = std::abs(a);
+    unsigned v = std::abs(b);
+
+    if(u == 0)
+        return v;
+    if(v == 0)
+        return u;
 
-    // cout << "Nbr asteroids: " << asteroids.size() << endl;
+    int shift = __builtin_ctz(u | v);
+    u >>= __builtin_ctz(u);
 
-    //for(auto a : asteroids)
-    //    cout << a << endl;
+    do
+    {
+        v >>= __builtin_ctz(v);
+        if(u > v)
+            std::swap(u, v);
+        v -= u;
+    } while(v != 0);
 
-    return;
+    return u << shift;
 }
 
-int
-computeVisibility(coords& ref, vector<coords>& asteroids)
+// Direction from a station to an asteroid, reduced by the gcd: all the
+// asteroids on a line of sight share the same direction, exactly.
+// The asteroid is the multiple-th one on that line of sight, if they were
+// all present.
+typedef struct
+{
+    int dx;
+    int dy;
+    int multiple;
+} direction;
+
+// Reduces the directions of a field. The gcd of every |dx|, |dy| of the
+// field is tabulated when the field is small enough, the table lookup is
+// much cheaper than the gcd loop for the n^2 pairs.
+class direction_reducer
+{
+    static constexpr long long MAX_TABLE_SIZE = 1 << 22;
+
+    int height_;
+    vector<int> gcds_;
+
+    int gcd(int dx, int dy) const
+    {
+        if(gcds_.empty())
+            return binary_gcd(dx, dy);
+
+        return gcds_[std::abs(dx) * height_ + std::abs(dy)];
+    }
+
+public:
+
+    explicit direction_reducer(const vector<coords>& asteroids)
+        : height_(0)
+    {
+        if(asteroids.empty())
+            return;
+
+        auto [minX, maxX] = std::minmax_element(asteroids.begin(), asteroids.end(),
+            [](const coords& a, const coords& b) { return a.x < b.x; });
+        auto [minY, maxY] = std::minmax_element(asteroids.begin(), asteroids.end(),
+            [](const coords& a, const coords& b) { return a.y < b.y; });
+
+        long long width = (long long)maxX->x - minX->x + 1;
+        long long height = (long long)maxY->y - minY->y + 1;
+
+        if(width * height > MAX_TABLE_SIZE)
+            return;
+
+        height_ = height;
+        gcds_.resize(width * height);
+        for(int dx=0; dx<width; dx++)
+            for(int dy=0; dy<height; dy++)
+                gcds_[dx * height_ + dy] = (dx || dy) ? binary_gcd(dx, dy) : 1;
+    }
+
+    direction reduce(const coords& station, const coords& a) const
+    {
+        int dx = a.x - station.x;
+        int dy = a.y - station.y;
+        int g = gcd(dx, dy);
+
+        return {dx / g, dy / g, g};
+    }
+};
+
+uint64_t direction_key(const direction& d)
+{
+    return (uint64_t(uint32_t(d.dx)) << 32) | uint32_t(d.dy);
+}
+
+// Open addressing set of direction keys, of fixed capacity. Each slot is
+// stamped with the station that filled it, so a new station starts from
+// an empty set without clearing anything.
+class direction_set
 {
-    int deltax, deltay, dist2;
-    double slope;
+    vector<uint64_t> keys_;
+    vector<uint32_t> stamps_;
+    uint32_t current_;
+    int shift_;
 
-    vector<coords> pos_deltax, neg_deltax;
-    vector<coords> pos_deltay, neg_deltay;
-    map<double, coords> diag_delta;
+public:
 
-    for(auto a : asteroids)
+    explicit direction_set(size_t maxSize)
+        : current_(0),
+          shift_(64)
     {
-        if(a != ref)
+        // Load factor below 1/2
+        size_t capacity = 1;
+        while(capacity < 2 * maxSize)
         {
-            deltax = a.x - ref.x;
-            deltay = a.y - ref.y;
-            dist2 = deltax*deltax + deltay*deltay;
+            capacity *= 2;
+            shift_--;
+        }
 
-            if(abs(deltax) == 0)
-            {
-                // Vertical alignment
-                if(deltay > 0)
-                {
-                    pos_deltay.push_back(a);
-                }
-                else
-                {
-                    neg_deltay.push_back(a);
-                }
-            }
-            else if (abs(deltay) == 0)
-            {
-                // Horizontal alignment
-                if(deltax > 0)
-                {
-                    pos_deltax.push_back(a);
-                }
-                else
-                {
-                    neg_deltax.push_back(a);
-                }
-            }
-            else
+        keys_.resize(capacity);
+        stamps_.assign(capacity, 0);
+    }
+
+    void clear()
+    {
+        current_++;
+    }
+
+    // True if new
+    bool insert(uint64_t key)
+    {
+        const size_t mask = keys_.size() - 1;
+        size_t i = shift_ < 64 ? (key * 0x9e3779b97f4a7c15ULL) >> shift_ : 0;
+
+        for(; ; i = (i + 1) & mask)
+        {
+            if(stamps_[i] != current_)
             {
-                // Diagonal alignment
-                double quadrant_indicator;
-
-                if(deltax > 0.0 && deltay > 0.0)
-                    quadrant_indicator = 100.0;
-                else if(deltax < 0.0 && deltay > 0.0)
-                    quadrant_indicator = 200.0;
-                else if(deltax < 0.0 && deltay < 0.0)
-                    quadrant_indicator = 300.0;
-                else
-                    quadrant_indicator = 400.0;
-
-                slope = double(deltay)/deltax + quadrant_indicator;
-                diag_delta[slope] = a;
-
-                //cout << ref << " : " << a << " : dist2: " << dist2 << " : slope: " << slope<< endl;
+                stamps_[i] = current_;
+                keys_[i] = key;
+                return true;
             }
+
+            if(keys_[i] == key)
+                return false;
         }
     }
+};
 
-    int direct_los =
-        (pos_deltax.size() > 0 ? 1 : 0) +
-        (pos_deltay.size() > 0 ? 1 : 0) +
-        (neg_deltax.size() > 0 ? 1 : 0) +
-        (neg_deltay.size() > 0 ? 1 : 0) +
-        diag_delta.size();
+// Number of asteroids seen from the station: one per direction
+int
+computeVisibility(const coords& station, const vector<coords>& asteroids,
+                  const direction_reducer& reducer, direction_set& directions)
+{
+    directions.clear();
 
-    // cout << ref << " : direct los: " << direct_los << endl;
+    int nbrVisible = 0;
+    for(auto& a : asteroids)
+    {
+        if(a != station)
+            nbrVisible += directions.insert(direction_key(reducer.reduce(station, a)));
+    }
 
-    return direct_los ;
+    return nbrVisible;
 }
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data, coords& bestLocation)
+// Station seeing the most asteroids, the first one on ties.
+// The stations are spread over the threads, interleaved.
+// nbrThreads: 0 for all the hardware threads
+int
+findBestStation(const vector<coords>& asteroids, int& maxVisibility, int nbrThreads = 0)
 {
-    //for(auto d : data)
-    //    cout << d << endl;
+    const int n = asteroids.size();
 
-    vector<coords> asteroids;
-    extractAsteroids(data, asteroids);
+    if(nbrThreads <= 0)
+        nbrThreads = std::max(1u, std::thread::hardware_concurrency());
+    nbrThreads = std::max(1, std::min(nbrThreads, n));
 
-    int max_visibility = 0;
+    const direction_reducer reducer(asteroids);
 
-    for(auto a : asteroids)
+    // Best (visibility, station) per thread
+    vector<pair<int, int>> best(nbrThreads, {-1, -1});
+
+    auto work = [&](int t)
     {
-        int nbr_visible = computeVisibility(a, asteroids);
+        direction_set directions(n);
 
-        if(nbr_visible  > max_visibility)
+        for(int i=t; i<n; i+=nbrThreads)
         {
-            max_visibility = nbr_visible;
-            bestLocation = a;
+            int visible = computeVisibility(asteroids[i], asteroids, reducer, directions);
+            if(visible > best[t].first)
+                best[t] = {visible, i};
         }
+    };
+
+    vector<thread> threads;
+    for(int t=1; t<nbrThreads; t++)
+        threads.emplace_back(work, t);
+
+    work(0);
+
+    for(auto& t : threads)
+        t.join();
+
+    pair<int, int> result = {-1, -1};
+    for(auto& b : best)
+    {
+        if(b.first > result.first || (b.first == result.first && b.second < result.second))
+            result = b;
     }
 
-    //cout << "max_visibility: " << max_visibility << " at location: " << bestLocation << endl;
+    maxVisibility = result.first;
+
+    return result.second;
+}
+
+// Half turn of a direction, with the y axis pointing down: 0 from up
+// (included) to down (excluded), clockwise, 1 for the other half
+int half(const direction& d)
+{
+    return (d.dx > 0 || (d.dx == 0 && d.dy < 0)) ? 0 : 1;
+}
+
+// Clockwise from up, exactly: same half, then the sign of the cross product
+bool clockwiseBefore(const direction& a, const direction& b)
+{
+    int ha = half(a);
+    int hb = half(b);
+    if(ha != hb)
+        return ha < hb;
+
+    return (long long)a.dx * b.dy - (long long)a.dy * b.dx > 0;
+}
+
+// Solve puzzle #1
+template <typename T>
+int solve_puzzle1(T data, coords& bestLocation)
+{
+    vector<coords> asteroids;
+    extractAsteroids(data, asteroids);
+
+    int max_visibility = 0;
+    int best = findBestStation(asteroids, max_visibility);
+
+    if(best >= 0)
+        bestLocation = asteroids[best];
 
     return max_visibility;
 }
@@ -157,52 +292,47 @@ int solve_puzzle2(T data, coords& bestLocation, int targetToVaporize)
     vector<coords> asteroids;
     extractAsteroids(data, asteroids);
 
-    // map sorted from greatest angle to smallest
-    // set sorted from closest to farthest using the < operator
-    map<double, set<coords>, std::greater<double> > clockwiseSortedAsteroids;
+    const direction_reducer reducer(asteroids);
 
-    // Compute angle between best location and all asteroids
-    for(auto a : asteroids)
+    vector<direction> targets;
+    for(auto& a : asteroids)
     {
         if(a != bestLocation)
-        {
-            //By flipping the y and x axis, we get angle values going from max pos to min neg clockwise
-            coords delta = {a.y - bestLocation.y, a.x - bestLocation.x};
-
-            double angle =  myutils::atan2InDeg(delta);
-            clockwiseSortedAsteroids[angle].insert(delta);
-        }
+            targets.push_back(reducer.reduce(bestLocation, a));
     }
 
-    // Now iterate through the map, removing the closest available asteroids each time
-    int nbrVaporize = 0;
-    coords lastBlastedAsteroid;
+    assert(targetToVaporize >= 1 && targetToVaporize <= (int)targets.size() && "Not enough asteroids to vaporize");
 
-    do
+    // Clockwise, then closest first on each line of sight
+    std::sort(targets.begin(), targets.end(), [](const direction& a, const direction& b)
     {
-        for (auto const& sortedAsteroids : clockwiseSortedAsteroids)
-        {
-            if(!sortedAsteroids.second.empty())
-            {
-                coords delta_blastedAsteroid = *(sortedAsteroids.second.begin());
-
-                // Remove from set
-                clockwiseSortedAsteroids[sortedAsteroids.first].erase(delta_blastedAsteroid);
-
-                nbrVaporize++;
+        if(a.dx != b.dx || a.dy != b.dy)
+            return clockwiseBefore(a, b);
+        return a.multiple < b.multiple;
+    });
+
+    // The laser goes around and around, the k-th asteroid of a line of
+    // sight goes on turn k: the order is (turn, angle)
+    vector<pair<int, int>> order;
+    order.reserve(targets.size());
+
+    int turn = 0;
+    for(size_t i=0; i<targets.size(); i++)
+    {
+        bool sameLine = i > 0 && targets[i].dx == targets[i - 1].dx && targets[i].dy == targets[i - 1].dy;
+        turn = sameLine ? turn + 1 : 0;
 
-                lastBlastedAsteroid = bestLocation + coords(delta_blastedAsteroid.y, delta_blastedAsteroid.x);
+        order.emplace_back(turn, i);
+    }
 
-                //cout << "blasted #: " << nbrVaporize << " : " <<  sortedAsteroids.first << " : " << lastBlastedAsteroid
-                //    << " : remaining: " << clockwiseSortedAsteroids[sortedAsteroids.first].size() << endl;
+    auto nth = order.begin() + (targetToVaporize - 1);
+    std::nth_element(order.begin(), nth, order.end());
 
-                if(nbrVaporize == targetToVaporize)
-                    break;
-            }
-        }
-    } while( nbrVaporize < targetToVaporize);
+    const direction& d = targets[nth->second];
+    int x = bestLocation.x + d.dx * d.multiple;
+    int y = bestLocation.y + d.dy * d.multiple;
 
-    return lastBlastedAsteroid.x*100 + lastBlastedAsteroid.y;
+    return x*100 + y;
 }
 
 int main(int argc, char *argv[])
@@ -5,161 +5,463 @@
 //
 
 #include <iostream>
+#include <fstream>
 #include <cassert>
+#include <cstdint>
+#include <climits>
 #include <vector>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
 #include "myutils.h"
-#include <map>
-#include <set>
 
 #include "Intcode.h"
 
 using namespace std;
 
-typedef myutils::point coords;
-
+// Clockwise: turning is adding 1 (right) or 3 (left) modulo 4
 typedef enum
 {
     NORTH = 0,
-    SOUTH = 1,
-    EAST  = 2,
+    EAST  = 1,
+    SOUTH = 2,
     WEST  = 3
 } direction;
 
-std::ostream& operator<<(std::ostream& os, const direction& dir)
-{
-    string dirStr;
-    switch (dir)
-    {
-        case NORTH:
-            dirStr = "North";
-            break;
-        case SOUTH:
-            dirStr = "South";
-            break;
-        case EAST:
-            dirStr = "East";
-            break;
-        case WEST:
-            dirStr = "West";
-            break;
-    }
+// Moves, indexed by direction. North is toward +y.
+const int dirX[4] = { 0, 1,  0, -1};
+const int dirY[4] = { 1, 0, -1,  0};
 
-    return os << dirStr;
+// The robot outputs 0 to turn left, 1 to turn right
+direction turn(direction dir, long long toRight)
+{
+    return direction((dir + (toRight ? 1 : 3)) & 3);
 }
 
-long encodePosition(coords p)
+std::ostream& operator<<(std::ostream& os, const direction& dir)
 {
-    return 1000*p.y + p.x;
+    static const char* names[4] = {"North", "East", "South", "West"};
+    return os << names[dir];
 }
 
-// Solve puzzle #1
-template <typename T>
-long long solve_puzzle1(T data, int startingColor, bool plotTrace, bool debug)
+// The hull panels painted by the robot.
+//
+// A panel is a byte: PAINTED once painted at least once, plus its color.
+// The canvas starts as a dense grid around the panels seen so far, grown
+// by doubling the dimension that overflowed. Past MAX_DENSE_CELLS it
+// switches to a sparse map of TILE x TILE tiles, allocated on first touch:
+// the memory follows the area actually walked, not its bounding box.
+// Coordinates are 64-bit, and the tiles are keyed on both full 64-bit tile
+// coordinates.
+class hull_canvas
 {
-    if(debug)
+public:
+
+    static constexpr unsigned char PAINTED = 2;
+
+private:
+
+    static constexpr long long MAX_DENSE_CELLS = 1LL << 24;
+
+    // Largest painted area rendered, in panels (an 8 MB PBM)
+    static constexpr long long MAX_RENDER_CELLS = 1LL << 26;
+    static constexpr int TILE_BITS = 6;
+    static constexpr int TILE = 1 << TILE_BITS;
+
+    typedef array<unsigned char, TILE * TILE> tile;
+
+    // Tile coordinates: the panel coordinates over TILE
+    typedef pair<long long, long long> tileKey;
+
+    struct tile_key_hash
     {
-        cout << endl << "Solve puzzle1:" << endl;
+        size_t operator()(const tileKey& k) const
+        {
+            uint64_t h = uint64_t(k.first) * 0x9e3779b97f4a7c15ULL;
+            h ^= h >> 32;
+            return h ^ (uint64_t(k.second) * 0xc2b2ae3d27d4eb4fULL);
+        }
+    };
+
+    // Dense grid, cell (x, y) at [(y - originY_) * width_ + x - originX_]
+    vector<unsigned char> dense_;
+    long long originX_;
+    long long originY_;
+    long long width_;
+    long long height_;
+
+    // Sparse tiles
+    bool sparse_;
+    unordered_map<tileKey, unique_ptr<tile>, tile_key_hash> tiles_;
 
-        for(auto d : data)
-            cout << d << " : " ;
-        cout << endl;
+    // The walk stays in the same tile most of the time
+    tileKey lastKey_;
+    tile* lastTile_;
+
+    long long nbrPainted_;
+    long long minX_, maxX_, minY_, maxY_;
+
+    static tileKey tile_key(long long x, long long y)
+    {
+        return {x >> TILE_BITS, y >> TILE_BITS};
     }
 
-    // Initialize painting program
-    Intcode computer(data, startingColor);
+    static int tile_index(long long x, long long y)
+    {
+        return (y & (TILE - 1)) * TILE + (x & (TILE - 1));
+    }
 
-    // Control the flow of input/output
-    computer.setPipeOutputMode(true);
+    bool in_dense(long long x, long long y) const
+    {
+        return x >= originX_ && x < originX_ + width_ && y >= originY_ && y < originY_ + height_;
+    }
 
-    // Initialize painting area. Encode position
-    map<long, int> hull;
-    map<long, string, std::greater<long> > hullStr;
+    unsigned char* find_tile(long long x, long long y)
+    {
+        tileKey key = tile_key(x, y);
+        if(lastTile_ && key == lastKey_)
+            return lastTile_->data();
 
-    // Robot position and direction
-    coords curPos(0, 0);             // Start at (0, 0)
-    direction curDir(NORTH);   // Point up toward +y
+        auto it = tiles_.find(key);
+        if(it == tiles_.end())
+            return nullptr;
 
-    // Precompute all combination of direction changes
-    map<direction, coords> dirNum;
+        lastKey_ = key;
+        lastTile_ = it->second.get();
+        return lastTile_->data();
+    }
 
-    dirNum[NORTH] = coords( 0,  1);
-    dirNum[SOUTH] = coords( 0, -1);
-    dirNum[EAST]  = coords( 1,  0);
-    dirNum[WEST]  = coords(-1,  0);
+    unsigned char* make_tile(long long x, long long y)
+    {
+        unsigned char* t = find_tile(x, y);
+        if(t)
+            return t;
 
-    map<direction, vector<direction> > dirChanges;
-    // index 0: left  90 degrees
-    // index 1: right 90 degrees
-    dirChanges[NORTH].push_back(WEST);  // From ^ to <
-    dirChanges[NORTH].push_back(EAST);  // From ^ to >
-    dirChanges[SOUTH].push_back(EAST);  // From v to >
-    dirChanges[SOUTH].push_back(WEST);  // From v to <
+        auto& slot = tiles_[tile_key(x, y)];
+        slot = make_unique<tile>();
+        slot->fill(0);
 
-    dirChanges[EAST].push_back(NORTH);  // From > to ^
-    dirChanges[EAST].push_back(SOUTH);  // From > to v
-    dirChanges[WEST].push_back(SOUTH);  // From < to v
-    dirChanges[WEST].push_back(NORTH);  // From < to ^
+        lastKey_ = tile_key(x, y);
+        lastTile_ = slot.get();
+        return lastTile_->data();
+    }
 
-    // Set curent color
-    long long currentColor = startingColor;
+    void to_sparse()
+    {
+        for(long long j=0; j<height_; j++)
+        {
+            for(long long i=0; i<width_; i++)
+            {
+                unsigned char v = dense_[j * width_ + i];
+                if(v)
+                    make_tile(originX_ + i, originY_ + j)[tile_index(originX_ + i, originY_ + j)] = v;
+            }
+        }
 
-    // Run until halted
-    while(!computer.isHalted())
+        vector<unsigned char>().swap(dense_);
+        width_ = height_ = 0;
+        sparse_ = true;
+    }
+
+    // Grow the dense grid to hold (x, y), or switch to the sparse tiles
+    void grow(long long x, long long y)
     {
-        long long colorToPaint = computer.run();
-        long long nextDir      = computer.run();
+        long long minX = std::min(originX_, x);
+        long long minY = std::min(originY_, y);
+        long long maxX = std::max(originX_ + width_ - 1, x);
+        long long maxY = std::max(originY_ + height_ - 1, y);
+
+        // Double the dimension that overflowed, toward the growth
+        long long width = width_;
+        if(x < originX_ || x >= originX_ + width_)
+            width = std::max(2 * width_, maxX - minX + 1);
+
+        long long height = height_;
+        if(y < originY_ || y >= originY_ + height_)
+            height = std::max(2 * height_, maxY - minY + 1);
+
+        // Divided: the product of far apart coordinates would overflow
+        if(width > MAX_DENSE_CELLS / height)
+        {
+            to_sparse();
+            return;
+        }
 
-        if(debug)
-            cout << "curPos: " << curPos << " : current color: " << currentColor << " : colorToPaint: " << colorToPaint << " : nextDir: " << dirChanges[curDir][nextDir] << endl;
+        long long originX = x < originX_ ? maxX - width + 1 : minX;
+        long long originY = y < originY_ ? maxY - height + 1 : minY;
+
+        vector<unsigned char> grid(width * height, 0);
+        for(long long j=0; j<height_; j++)
+            std::copy_n(&dense_[j * width_], width_,
+                        &grid[(originY_ + j - originY) * width + originX_ - originX]);
+
+        dense_.swap(grid);
+        originX_ = originX;
+        originY_ = originY;
+        width_ = width;
+        height_ = height;
+    }
+
+    unsigned char& cell(long long x, long long y)
+    {
+        if(!sparse_ && !in_dense(x, y))
+            grow(x, y);
+
+        if(!sparse_)
+            return dense_[(y - originY_) * width_ + x - originX_];
+
+        return make_tile(x, y)[tile_index(x, y)];
+    }
+
+public:
+
+    hull_canvas()
+        : dense_(TILE * TILE, 0),
+          originX_(-TILE / 2),
+          originY_(-TILE / 2),
+          width_(TILE),
+          height_(TILE),
+          sparse_(false),
+          lastKey_(0, 0),
+          lastTile_(nullptr),
+          nbrPainted_(0),
+          minX_(LLONG_MAX), maxX_(LLONG_MIN), minY_(LLONG_MAX), maxY_(LLONG_MIN)
+    {}
+
+    // Color of a panel, 0 (black) if never painted
+    int color(long long x, long long y)
+    {
+        if(!sparse_)
+            return in_dense(x, y) ? dense_[(y - originY_) * width_ + x - originX_] & 1 : 0;
+
+        unsigned char* t = find_tile(x, y);
+        return t ? t[tile_index(x, y)] & 1 : 0;
+    }
+
+    void paint(long long x, long long y, int color)
+    {
+        unsigned char& c = cell(x, y);
+
+        if(!(c & PAINTED))
+        {
+            nbrPainted_++;
+            minX_ = std::min(minX_, x);
+            maxX_ = std::max(maxX_, x);
+            minY_ = std::min(minY_, y);
+            maxY_ = std::max(maxY_, y);
+        }
+
+        c = PAINTED | (color & 1);
+    }
+
+    // Number of panels painted at least once
+    long long nbr_painted() const
+    {
+        return nbrPainted_;
+    }
+
+    bool is_sparse() const
+    {
+        return sparse_;
+    }
+
+    // Can the painted area be rendered: at most MAX_RENDER_CELLS panels
+    bool renderable() const
+    {
+        if(nbrPainted_ == 0)
+            return false;
+
+        // Divided: the product of far apart coordinates would overflow
+        long long width = maxX_ - minX_ + 1;
+        long long height = maxY_ - minY_ + 1;
+        return width <= MAX_RENDER_CELLS / height;
+    }
+
+    // Rows of the painted area, top (largest y) first, if renderable.
+    //
+    // The dense grid is read directly. The sparse tiles are sorted by tile
+    // row, and each band of TILE rows is filled from the tiles allocated in
+    // it: no lookup per panel, and no cost for the area never walked
+    // besides the output itself.
+    template <typename Row>
+    void for_each_row(Row row)
+    {
+        if(!renderable())
+            return;
+
+        const long long width = maxX_ - minX_ + 1;
 
-        // Numeric hull
-        hull[encodePosition(curPos)] = colorToPaint;
+        if(!sparse_)
+        {
+            vector<unsigned char> line(width);
+            for(long long y=maxY_; y>=minY_; y--)
+            {
+                for(long long x=minX_; x<=maxX_; x++)
+                    line[x - minX_] = color(x, y);
+                row(line);
+            }
+            return;
+        }
+
+        // Tiles from the top tile row down
+        vector<pair<tileKey, const tile*>> byRow;
+        byRow.reserve(tiles_.size());
+        for(auto& [key, t] : tiles_)
+            byRow.emplace_back(key, t.get());
 
-        if(plotTrace)
+        std::sort(byRow.begin(), byRow.end(), [](const auto& a, const auto& b)
         {
-            // String hull
-            string curStr = hullStr.find(curPos.y) == hullStr.end() ? "" : hullStr[curPos.y];
+            return a.first.second > b.first.second;
+        });
 
-            if(curStr.size() < curPos.x + 1)
-                curStr.resize(curPos.x + 1, ' ');
-            curStr[curPos.x] = (colorToPaint == 1 ? '*' : ' ');
-            hullStr[curPos.y] = curStr;
+        auto next = byRow.begin();
+        vector<unsigned char> line(width);
+
+        for(long long ty = maxY_ >> TILE_BITS; ty >= (minY_ >> TILE_BITS); ty--)
+        {
+            // Rows of the band inside the painted area
+            const long long bandMinY = std::max(minY_, ty << TILE_BITS);
+            const long long bandMaxY = std::min(maxY_, (ty << TILE_BITS) + TILE - 1);
+
+            vector<unsigned char> band((bandMaxY - bandMinY + 1) * width, 0);
+
+            for(; next != byRow.end() && next->first.second == ty; ++next)
+            {
+                const tile& t = *next->second;
+                const long long tileX = next->first.first << TILE_BITS;
+
+                for(long long y=bandMinY; y<=bandMaxY; y++)
+                {
+                    for(long long x=std::max(minX_, tileX); x<=std::min(maxX_, tileX + TILE - 1); x++)
+                        band[(y - bandMinY) * width + x - minX_] = t[tile_index(x, y)] & 1;
+                }
+            }
+
+            for(long long y=bandMaxY; y>=bandMinY; y--)
+            {
+                std::copy_n(&band[(y - bandMinY) * width], width, line.begin());
+                row(line);
+            }
         }
+    }
 
-        // Change direction and position
-        curDir = dirChanges[curDir][nextDir];
-        curPos = curPos + dirNum[curDir];
+    // White panels as '*'
+    void render_text(ostream& os, char white = '*', char black = ' ')
+    {
+        if(nbrPainted_ > 0 && !renderable())
+        {
+            os << "(painted area too large to render)" << '\n';
+            return;
+        }
+
+        for_each_row([&](const vector<unsigned char>& line)
+        {
+            string s(line.size(), black);
+            for(size_t i=0; i<line.size(); i++)
+                if(line[i])
+                    s[i] = white;
+            os << s << '\n';
+        });
+    }
+
+    // Binary PBM (P4), the white panels as black pixels. Nothing is written
+    // when the painted area is not renderable.
+    void render_pbm(ostream& os)
+    {
+        if(!renderable())
+            return;
+
+        os << "P4\n" << (maxX_ - minX_ + 1) << " " << (maxY_ - minY_ + 1) << "\n";
+
+        for_each_row([&](const vector<unsigned char>& line)
+        {
+            vector<char> bits((line.size() + 7) / 8, 0);
+            for(size_t i=0; i<line.size(); i++)
+                if(line[i])
+                    bits[i / 8] |= 0x80 >> (i % 8);
+            os.write(bits.data(), bits.size());
+        });
+    }
+};
+
+// Run the painting robot on the hull, from the starting panel color
+template <typename T>
+void paint_hull(T data, int startingColor, hull_canvas& hull, bool debug = false)
+{
+    // Initialize painting program
+    Intcode computer(data, startingColor);
+
+    // Control the flow of input/output
+    computer.setPipeOutputMode(true);
+
+    // Robot position and direction
+    long long x = 0;
+    long long y = 0;
+    direction curDir(NORTH);   // Point up toward +y
+
+    // Run until halted
+    while(true)
+    {
+        long long colorToPaint = computer.run();
+        if(computer.isHalted())
+            break;
+
+        long long toRight = computer.run();
+        if(computer.isHalted())
+            break;
+
+        if(debug)
+            cout << "curPos: " << x << " " << y << " : colorToPaint: " << colorToPaint << " : nextDir: " << turn(curDir, toRight) << endl;
 
-        // We just move. Adjust current color
-        currentColor = hull.find(encodePosition(curPos)) == hull.end() ? 0 : hull[encodePosition(curPos)];
+        hull.paint(x, y, colorToPaint);
+
+        // Change direction and position
+        curDir = turn(curDir, toRight);
+        x += dirX[curDir];
+        y += dirY[curDir];
 
         // Tell computer current color
-        computer.setInput({currentColor});
+        computer.setInput({hull.color(x, y)});
     }
+}
+
+// Solve puzzle #1. The painted hull is also written to pbm, if any.
+template <typename T>
+long long solve_puzzle1(T data, int startingColor, bool plotTrace, bool debug, ostream* pbm = nullptr)
+{
+    if(debug)
+        cout << endl << "Solve puzzle1:" << endl;
+
+    hull_canvas hull;
+    paint_hull(data, startingColor, hull, debug);
 
     if(plotTrace)
     {
         cout << endl << "We plot the robot trace:"<< endl;
-
-        for(auto h : hullStr)
-            cout << h.second << endl;
+        hull.render_text(cout);
     }
 
-    return hull.size();
+    if(pbm)
+        hull.render_pbm(*pbm);
+
+    return hull.nbr_painted();
 }
 
 // Solve puzzle #2
 template <typename T>
-constexpr int solve_puzzle2(T data, bool plotTrace, bool debug = false)
+long long solve_puzzle2(T data, bool plotTrace, bool debug = false, ostream* pbm = nullptr)
 {
-    return solve_puzzle1(data, 1, plotTrace, debug);
+    return solve_puzzle1(data, 1, plotTrace, debug, pbm);
 }
 
 int main(int argc, char *argv[])
 {
-    // Need a command-line parameter for the input filename
-    if (argc != 2) {
+    // Need a command-line parameter for the input filename, and optionally
+    // a PBM image filename for the registration identifier
+    if (argc != 2 && argc != 3) {
         cerr << "Error: missing input" << endl;
+        cerr << "Usage: " << argv[0] << " input [identifier.pbm]" << endl;
         return EXIT_FAILURE;
     }
 
@@ -183,8 +485,13 @@ int main(int argc, char *argv[])
     std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data, 0, false, false) << std::endl;
 
     // --------- Puzzle #2 ---------
-    assert(solve_puzzle2(data, false, false) == 250 && "Error verifying puzzle #2");
+    // Solve puzzle #2 : FKEKCFRK, and the image of the identifier
+    ofstream pbm;
+    if(argc == 3)
+        pbm.open(argv[2], ios::binary);
+
+    long long answer2 = solve_puzzle2(data, true, false, argc == 3 ? &pbm : nullptr);
+    assert(answer2 == 250 && "Error verifying puzzle #2");
 
-    // Solve puzzle #2 : FKEKCFRK
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data, true) << std::endl;
+    std::cout << "Answer for puzzle #2: "<< answer2 << std::endl;
 }
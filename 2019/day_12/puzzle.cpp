@@ -7,366 +7,244 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 #include "myutils.h"
-#include <sstream>
 #include <algorithm>
 #include <numeric>
-#include <iomanip>
 
 using namespace std;
 
-typedef enum
-{
-    IO       = 0,
-    EUROPA   = 1,
-    GANYMEDE = 2,
-    CALLISTO = 3
-} Moons;
-
-typedef struct moonMotion
+// One axis of the N-body system. The axes do not interact: each one is
+// simulated, and its cycle found, on its own.
+//
+// Structure of arrays: the positions and the velocities are int32 arrays,
+// padded to a multiple of LANES bodies. The gravity works on LANES bodies
+// at a time in vector registers: one sign comparison against every other
+// body's position, broadcast.
+class nbody_axis
 {
-    int  x,  y,  z;  // Position
-    int vx, vy, vz;  // Velocity
+    static constexpr int LANES = 8;
+    typedef int32_t ints __attribute__((vector_size(4 * LANES)));
 
-    moonMotion()
-        : x(0), y(0), z(0), vx(0), vy(0), vz(0)
-        {}
+    int nbrBodies_;
+    vector<ints> pos_;
+    vector<ints> vel_;
 
-    moonMotion(int mx, int my, int mz, int mvx = 0, int mvy = 0, int mvz = 0)
-        : x(mx), y(my), z(mz), vx(mvx), vy(mvy), vz(mvz)
-        {}
+    // Lanes holding a body, per block
+    vector<ints> valid_;
 
-    moonMotion(const moonMotion& m)
-        : x(m.x), y(m.y), z(m.z), vx(m.vx), vy(m.vy), vz(m.vz)
-        {}
+public:
 
-    bool operator!=(const moonMotion &other)
+    explicit nbody_axis(const vector<int>& positions)
+        : nbrBodies_(positions.size())
     {
-        return
-            x  != other.x  ||
-            y  != other.y  ||
-            z  != other.z  ||
-            vx != other.vx ||
-            vy != other.vy ||
-            vz != other.vz;
+        int nbrBlocks = (nbrBodies_ + LANES - 1) / LANES;
+
+        pos_.assign(nbrBlocks, ints{});
+        vel_.assign(nbrBlocks, ints{});
+        valid_.assign(nbrBlocks, ints{});
+
+        for(int i=0; i<nbrBodies_; i++)
+        {
+            pos_[i / LANES][i % LANES] = positions[i];
+            valid_[i / LANES][i % LANES] = -1;
+        }
     }
 
-    bool operator==(const moonMotion &other)
+    int position(int i) const
     {
-        return
-            x  == other.x  &&
-            y  == other.y  &&
-            z  == other.z  &&
-            vx == other.vx &&
-            vy == other.vy &&
-            vz == other.vz;
+        return pos_[i / LANES][i % LANES];
     }
 
-} moonMotion;
-
-std::ostream& operator<<(std::ostream& os, const moonMotion& mm)
-{
-    return os << std::setw(10)
-        << "pos=<x=" << std::setw(3) << mm.x << ", "
-        << "y="      << std::setw(3) << mm.y << ", "
-        << "z="      << std::setw(3) << mm.z << ">, "
-        << "vel=<x=" << std::setw(3) << mm.vx << ", "
-        << "y="      << std::setw(3) << mm.vy << ", "
-        << "z="      << std::setw(3) << mm.vz << ">";
-}
-
-bool operator !=(const vector<moonMotion>& m1, const vector<moonMotion>& m2)
-{
-    bool isSame = true;
-    int vsize = m1.size();
-
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].x  == m2[i].x);
-
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].y  == m2[i].y);
-
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].z  == m2[i].z);
-
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].vx  == m2[i].vx);
+    int velocity(int i) const
+    {
+        return vel_[i / LANES][i % LANES];
+    }
 
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].vy  == m2[i].vy);
+    void step()
+    {
+        const int nbrBlocks = pos_.size();
 
-    for(int i=0; isSame && i<vsize; i++)
-        isSame &= (m1[i].vz  == m2[i].vz);
+        // Gravity: every body moves its velocity by 1 toward every other one
+        for(int b=0; b<nbrBlocks; b++)
+        {
+            const ints p = pos_[b];
+            ints pull = {};
 
-    return !isSame;
-}
+            for(int j=0; j<nbrBodies_; j++)
+            {
+                const ints other = ints{} + position(j);
 
+                // The comparisons are -1 when true
+                pull += (p > other) - (p < other);
+            }
 
-template <typename T>
-vector<moonMotion>
-extractMoonsPos(T data)
-{
-    //for(auto d : data)
-    //    cout << d << endl;
+            vel_[b] += pull & valid_[b];
+        }
 
-    vector<moonMotion> moons;
+        // Velocity
+        for(int b=0; b<nbrBlocks; b++)
+            pos_[b] += vel_[b];
+    }
 
-    vector<int> numVals;
-    int moonIndex = 0;
-    for(auto d : data)
+    bool same_state(const nbody_axis& other) const
     {
-        // Remove junk
-        d.erase(std::remove(d.begin(), d.end(), ','), d.end());
-        d.erase(std::remove(d.begin(), d.end(), '>'), d.end());
-
-        string token;
-        std::stringstream tokenSplitter(d);
-        getline(tokenSplitter, token, '=');
-        getline(tokenSplitter, token, '=');
-
-        numVals.push_back(stoi(token));
+        return memcmp(pos_.data(), other.pos_.data(), pos_.size() * sizeof(ints)) == 0 &&
+               memcmp(vel_.data(), other.vel_.data(), vel_.size() * sizeof(ints)) == 0;
     }
 
-    moonMotion Io      (numVals[0], numVals[1],  numVals[2]);
-    moonMotion Europa  (numVals[3], numVals[4],  numVals[5]);
-    moonMotion Ganymede(numVals[6], numVals[7],  numVals[8]);
-    moonMotion Callisto(numVals[9], numVals[10], numVals[11]);
-
-    moons.push_back(Io);
-    moons.push_back(Europa);
-    moons.push_back(Ganymede);
-    moons.push_back(Callisto);
-
-    return moons;
-}
-
-void
-computeGravity(vector<moonMotion>& moons)
-{
-    int delta;
-
-    for(int index1 = 0; index1 < moons.size(); index1++)
+    bool at_rest() const
     {
-        moonMotion& m1 = moons[index1];
-        for(int index2 = index1+1; index2 < moons.size(); index2++)
+        for(auto& v : vel_)
         {
-            moonMotion& m2 = moons[index2];
-
-            delta = myutils::sgn(m1.x - m2.x);
-            m1.vx -= delta;
-            m2.vx += delta;
-
-            delta = myutils::sgn(m1.y - m2.y);
-            m1.vy -= delta;
-            m2.vy += delta;
-
-            delta = myutils::sgn(m1.z - m2.z);
-            m1.vz -= delta;
-            m2.vz += delta;
+            for(int i=0; i<LANES; i++)
+                if(v[i] != 0)
+                    return false;
         }
+        return true;
     }
 
-    return;
-}
-
-void
-computeVelocity(vector<moonMotion>& moons)
-{
-    for(auto& m : moons)
+    // Number of steps until the initial state comes back.
+    //
+    // A step is reversible: the previous state is found from the current
+    // one, so the states form a pure cycle with no tail, and the first
+    // repeat is the initial state itself. No Floyd or Brent, one single
+    // simulation.
+    //
+    // Starting at rest, the motion is symmetric in time around the first
+    // instant the bodies are at rest again: the period is twice that, or
+    // that instant itself if the bodies are back at their start.
+    long long period() const
     {
-        m.x += m.vx;
-        m.y += m.vy;
-        m.z += m.vz;
-    }
-    return;
-}
+        nbody_axis state = *this;
 
-long
-computeEnergy(vector<moonMotion>& moons)
-{
-    long totEnergy = 0;
-    long potEnergy = 0;
-    long kinEnergy = 0;
-    for(auto& m : moons)
-    {
-        potEnergy = abs(m.x)  + abs(m.y)  + abs(m.z);
-        kinEnergy = abs(m.vx) + abs(m.vy) + abs(m.vz);
+        if(at_rest())
+        {
+            long long halfPeriod = 0;
+            do
+            {
+                state.step();
+                halfPeriod++;
+            } while(!state.at_rest());
+
+            return state.same_state(*this) ? halfPeriod : 2 * halfPeriod;
+        }
+
+        long long steps = 0;
+        do
+        {
+            state.step();
+            steps++;
+        } while(!state.same_state(*this));
 
-        totEnergy += potEnergy * kinEnergy;
+        return steps;
     }
-    return totEnergy;
-}
+};
 
-// Solve puzzle #1
-template <typename T>
-long solve_puzzle1(T data, int nbrTimeSteps)
+class nbody
 {
-    vector<moonMotion> moons = extractMoonsPos(data);
-    long totalEnergy = 0;
+    int nbrBodies_;
+    array<nbody_axis, 3> axes_;
 
-    for(int t=1; t<=nbrTimeSteps; t++)
+    static nbody_axis make_axis(const vector<array<int, 3>>& positions, int axis)
     {
-        computeGravity (moons);
-        computeVelocity(moons);
-        totalEnergy = computeEnergy(moons);
+        vector<int> p;
+        for(auto& pos : positions)
+            p.push_back(pos[axis]);
+        return nbody_axis(p);
     }
 
-    return totalEnergy;
-}
-
-// Floyd algorithm for finding cycle.
-void floyd_cycle_find(
-    vector<moonMotion>& moons,
-    long long& lambda,              // Loop length
-    long long& mu                   // Index of first encounter
-)
-{
-    long long nbrTimeSteps = 0;
+public:
 
-    // Starting point
-    vector<moonMotion> moonsTurtle = moons;
-    vector<moonMotion> moonsHare = moons;
+    explicit nbody(const vector<array<int, 3>>& positions)
+        : nbrBodies_(positions.size()),
+          axes_{make_axis(positions, 0), make_axis(positions, 1), make_axis(positions, 2)}
+    {}
 
-    // First part of Floyd algorithm
-    do
+    void simulate(long long nbrTimeSteps)
     {
-        // Evaluate turtle
-        computeGravity (moonsTurtle);
-        computeVelocity(moonsTurtle);
-
-        // Evaluate hare (goes twice as fast)
-        computeGravity (moonsHare);
-        computeVelocity(moonsHare);
-        computeGravity (moonsHare);
-        computeVelocity(moonsHare);
-
-        nbrTimeSteps++;
+        for(auto& axis : axes_)
+            for(long long t=0; t<nbrTimeSteps; t++)
+                axis.step();
     }
-    while(moonsTurtle != moonsHare);
-
-    moonsTurtle = moons;
 
-    mu = 0;
-    while(moonsTurtle != moonsHare)
+    long energy() const
     {
-        // Evaluate turtle
-        computeGravity (moonsTurtle);
-        computeVelocity(moonsTurtle);
-
-        // Evaluate hare (goes same speed as turtle)
-        computeGravity (moonsHare);
-        computeVelocity(moonsHare);
-
-        mu++;
-        nbrTimeSteps++;
+        long totEnergy = 0;
+        for(int i=0; i<nbrBodies_; i++)
+        {
+            long potEnergy = 0;
+            long kinEnergy = 0;
+            for(auto& axis : axes_)
+            {
+                potEnergy += abs(axis.position(i));
+                kinEnergy += abs(axis.velocity(i));
+            }
+            totEnergy += potEnergy * kinEnergy;
+        }
+        return totEnergy;
     }
 
-    lambda = nbrTimeSteps - mu;
-
-    return;
-}
+    // Period of the whole system: the lcm of the periods of the axes, each
+    // axis found on its own thread
+    long long period() const
+    {
+        array<long long, 3> periods;
+        vector<thread> threads;
 
-// Brent algorithm for finding cycle.
-// For this specific problem, this variant of the algorithm is not faster than Floyd algorithm
-void brent_cycle_find(
-    vector<moonMotion>& moons,
-    long long& lambda,              // Loop length
-    long long& mu                   // Index of first encounter
-)
-{
-    // Starting point
-    long long power;
-    power  = 1;
-    lambda = 1;
+        for(int a=0; a<3; a++)
+            threads.emplace_back([this, &periods, a]() { periods[a] = axes_[a].period(); });
 
-    vector<moonMotion> moonsTurtle = moons;
-    vector<moonMotion> moonsHare = moons;
+        for(auto& t : threads)
+            t.join();
 
-    // Evaluate hare
-    computeGravity (moonsHare);
-    computeVelocity(moonsHare);
+        return lcm(periods[0], lcm(periods[1], periods[2]));
+    }
+};
 
-    while(moonsTurtle != moonsHare)
+// Body positions, from "<x=-1, y=0, z=2>" lines, possibly split at the
+// spaces: every integer following a '=', three per body
+template <typename T>
+vector<array<int, 3>>
+extractMoonsPos(T data)
+{
+    vector<int> numVals;
+    for(auto& d : data)
     {
-        if(power == lambda)
-        {
-            moonsTurtle = moonsHare;
-            power *= 2;
-            lambda = 0;
-        }
-
-        computeGravity (moonsHare);
-        computeVelocity(moonsHare);
-        lambda++;
+        for(size_t pos = d.find('='); pos != string::npos; pos = d.find('=', pos + 1))
+            numVals.push_back(atoi(d.c_str() + pos + 1));
     }
 
-    moonsTurtle = moons;
-    moonsHare = moons;
+    assert(numVals.size() % 3 == 0 && "Incomplete body position");
 
-    mu = 0;
+    vector<array<int, 3>> moons(numVals.size() / 3);
+    for(size_t i=0; i<numVals.size(); i++)
+        moons[i / 3][i % 3] = numVals[i];
 
-    while(moonsTurtle != moonsHare)
-    {
-        computeGravity (moonsTurtle);
-        computeVelocity(moonsTurtle);
+    return moons;
+}
 
-        computeGravity (moonsHare);
-        computeVelocity(moonsHare);
-        mu++;
-    }
-    return;
+// Solve puzzle #1
+template <typename T>
+long solve_puzzle1(T data, int nbrTimeSteps)
+{
+    nbody moons(extractMoonsPos(data));
+    moons.simulate(nbrTimeSteps);
+
+    return moons.energy();
 }
 
 // Solve puzzle #2
-//
-// This is solved using the Floyd algorithm for finding cycles in a sequence.
-// https://en.wikipedia.org/wiki/Cycle_detection#Floyd's_Tortoise_and_Hare
-//
 template <typename T>
 long long solve_puzzle2(T data)
 {
-    long long lambdaX, lambdaY, lambdaZ;   // Loop length
-    long long muX, muY, muZ;               // Index of first encounter
-
-    // First, we compute the initial state of each moon
-    vector<moonMotion> moons = extractMoonsPos(data);
-
-    // x, y and z coords are moving independantly, so compute the frequencies of each coordinates
-    vector<moonMotion> moonsX = moons;
-    vector<moonMotion> moonsY = moons;
-    vector<moonMotion> moonsZ = moons;
-
-    for(auto &m : moonsX)
-    {
-        m.y = 0;
-        m.z = 0;
-        m.vy = 0;
-        m.vz = 0;
-    }
-
-    for(auto &m : moonsY)
-    {
-        m.x = 0;
-        m.z = 0;
-        m.vx = 0;
-        m.vz = 0;
-    }
-
-    for(auto &m : moonsZ)
-    {
-        m.x = 0;
-        m.y = 0;
-        m.vx = 0;
-        m.vy = 0;
-    }
-
-    cout << "Solving puzzle #2 using Floyd algorithm" << endl;
-    floyd_cycle_find(moonsX, lambdaX, muX);
-    floyd_cycle_find(moonsY, lambdaY, muY);
-    floyd_cycle_find(moonsZ, lambdaZ, muZ);
-
-    // The full period is the lcm of the 3 lambdas
-    return lcm(lambdaX, lcm(lambdaY, lambdaZ));
+    // x, y and z coords are moving independantly: the full period is the
+    // lcm of the period of each coordinate
+    return nbody(extractMoonsPos(data)).period();
 }
 
 int main(int argc, char *argv[])
@@ -408,7 +286,7 @@ int main(int argc, char *argv[])
          "z=-1>"
     };
     long nTimeSteps = 10;
-    //assert(solve_puzzle1(dataEx1, nTimeSteps) == 179 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(dataEx1, nTimeSteps) == 179 && "Error verifying puzzle #1");
 
     // Example2
     vector<string> dataEx2 = {
@@ -5,10 +5,11 @@
 //
 
 #include <iostream>
+#include <iomanip>
 #include <cassert>
 #include <vector>
+#include <string>
 #include "myutils.h"
-#include <map>
 
 #include "Intcode.h"
 #include <curses.h>
@@ -26,210 +27,264 @@ typedef enum
     TILE_BALL   = 4
 } tileType;
 
-// For screen rendering
-map<int, char> pixValue;
+// For screen rendering, indexed by tileType
+const char pixValue[] = " #*=O";
 
-// Solve puzzle #1
-template <typename T>
-long long solve_puzzle1(T data, int& xmin, int& xmax, int& ymin, int& ymax, bool debug = false)
+class arcade;
+
+// Watches a game: every tile and score update, and every frame, ie:
+// every time the game reads the joystick
+class arcade_observer
 {
-    if(debug)
-        cout << endl << "Solve puzzle1:" << endl;
+public:
+    virtual ~arcade_observer() {}
 
-    Intcode computer(data, 0, false);
+    virtual void tile(int x, int y, int tile) = 0;
+    virtual void score(long long score) = 0;
+    virtual void frame(const arcade& game) = 0;
+};
 
-    computer.setPipeOutputMode(true);
+// Headless arcade cabinet.
+//
+// The screen is a flat tile array, grown by doubling when the game draws
+// out of it.
+// The ball and paddle positions, the score and the number of blocks are
+// updated from each output triple as it comes, so the joystick is answered
+// in O(1), without looking at the screen.
+class arcade
+{
+    Intcode<std::vector<long long>, arcade> computer_;
 
-    long long output(0);
+    // Screen drawn so far, in a tile array of stride_ x rows_
+    int width_;
+    int height_;
+    int stride_;
+    int rows_;
+    vector<unsigned char> tiles_;
 
-    // We don't know the screen size apriori, so we encode the x,y screen coords into a integer value,
-    // and we dump the screentile value into a map.
-    int x, y, index;
-    map<int, long long> screen;
+    int ballX_;
+    int paddleX_;
+    long long score_;
+    int nbrBlocks_;
 
-    int counterTile2 = 0;
-    xmin = INT_MAX;
-    xmax = INT_MIN;
-    ymin = INT_MAX;
-    ymax = INT_MIN;
+    arcade_observer* observer_;
 
-    while(!computer.isHalted())
+    unsigned char& at(int x, int y)
     {
-        x = computer.run();
-        y = computer.run();
+        assert(x >= 0 && y >= 0 && "Tile out of the screen");
 
-        index = 100*y + x;
-        screen[index] = computer.run();
+        if(x >= stride_ || y >= rows_)
+        {
+            // Double the dimension that overflowed
+            int stride = x >= stride_ ? std::max(x + 1, 2 * stride_) : stride_;
+            int rows = y >= rows_ ? std::max(y + 1, 2 * rows_) : rows_;
 
-        if(screen[index] == TILE_BLOCK)
-            counterTile2++;
+            vector<unsigned char> tiles(stride * rows, TILE_EMPTY);
+            for(int j=0; j<height_; j++)
+                std::copy_n(&tiles_[j * stride_], width_, &tiles[j * stride]);
+
+            tiles_.swap(tiles);
+            stride_ = stride;
+            rows_ = rows;
+        }
 
-        xmin = std::min(xmin, x);
-        ymin = std::min(ymin, y);
-        xmax = std::max(xmax, x);
-        ymax = std::max(ymax, y);
+        width_ = std::max(width_, x + 1);
+        height_ = std::max(height_, y + 1);
+
+        return tiles_[y * stride_ + x];
     }
 
-    if(debug)
+    void update(long long x, long long y, long long value)
     {
-        cout << "Solution: nbr of tile 2 type: " << counterTile2 << endl;
+        // Segment display
+        if(x == -1 && y == 0)
+        {
+            score_ = value;
+            if(observer_)
+                observer_->score(value);
+            return;
+        }
+
+        unsigned char& t = at(x, y);
+
+        nbrBlocks_ += (value == TILE_BLOCK) - (t == TILE_BLOCK);
+        t = value;
+
+        if(value == TILE_BALL)
+            ballX_ = x;
+        else if(value == TILE_PADDLE)
+            paddleX_ = x;
+
+        if(observer_)
+            observer_->tile(x, y, value);
     }
 
-    if(debug)
+    // Next output of the program, false once halted
+    bool next_output(long long& value)
     {
-        // We dump the screen to stdout
-        cout << "xmin: " << xmin << endl;
-        cout << "ymin: " << ymin << endl;
+        value = computer_.run();
+        return !computer_.isHalted();
+    }
 
-        // Initialise pixel value for ASCII rendering
-        pixValue[TILE_EMPTY]  = ' ';
-        pixValue[TILE_WALL]   = '#';
-        pixValue[TILE_BLOCK]  = '*';
-        pixValue[TILE_PADDLE] = '=';
-        pixValue[TILE_BALL]   = 'O';
+    // The paddle follows the ball
+    static long long joystick(arcade* game)
+    {
+        if(game->observer_)
+            game->observer_->frame(*game);
 
-        int widthScreen = xmax - xmin + 1;
-        map<long, string> screenStr;
+        return myutils::sgn(game->ballX_ - game->paddleX_);
+    }
 
-        char buffer[widthScreen];
+public:
+
+    // nbrQuarters: 0 for the attract mode, 2 to play for free
+    arcade(std::vector<long long>& program, int nbrQuarters = 0, arcade_observer* observer = nullptr)
+        : computer_(program, std::vector<long long>(), false),
+          width_(0),
+          height_(0),
+          stride_(0),
+          rows_(0),
+          ballX_(0),
+          paddleX_(0),
+          score_(0),
+          nbrBlocks_(0),
+          observer_(observer)
+    {
+        computer_.setPipeOutputMode(true);
 
-        for(int i=ymin; i <= ymax; i++)
-            screenStr[i] = string(widthScreen+1, ' ');
+        if(nbrQuarters > 0)
+            computer_.setMemory(0, nbrQuarters);
 
-        for(auto pix : screen)
-        {
-            index = pix.first;
-            x = index % 100;
-            y = index / 100;
-            strcpy(buffer, screenStr[y].c_str());
-            buffer[x] = pixValue[pix.second];
+        // No queued input: every read is the joystick
+        computer_.setInputCallbackParam(this);
+        computer_.setInputCallback(joystick);
+    }
 
-            screenStr[y] = string(buffer);
-        }
+    arcade(const arcade&) = delete;
+    arcade& operator=(const arcade&) = delete;
 
-        for(auto str : screenStr)
-        {
-            cout << setw(2) << str.first << " : " << str.second << endl;
-        }
+    // Run the game until the program halts
+    void play()
+    {
+        long long x, y, value;
 
+        while(next_output(x) && next_output(y) && next_output(value))
+            update(x, y, value);
     }
-    return counterTile2;
-}
 
-void refreshScreen(map<long, vector<int>>& screen, int x, int y, int newTile, WINDOW* win,bool debug)
+    int width() const       { return width_; }
+    int height() const      { return height_; }
+    long long score() const { return score_; }
+    int nbr_blocks() const  { return nbrBlocks_; }
+
+    int tile(int x, int y) const
+    {
+        return tiles_[y * stride_ + x];
+    }
+};
+
+// ncurses rendering, at most fps frames per second (0: as fast as possible)
+class curses_observer : public arcade_observer
 {
-    if(x == -1)
+    std::chrono::steady_clock::duration framePeriod_;
+    std::chrono::steady_clock::time_point nextFrame_;
+
+public:
+
+    explicit curses_observer(int fps)
+        : framePeriod_(fps > 0 ? std::chrono::steady_clock::duration(std::chrono::seconds(1)) / fps
+                               : std::chrono::steady_clock::duration::zero()),
+          nextFrame_(std::chrono::steady_clock::now())
     {
-        screen[x][0] = newTile;
-        wmove(win, 0, 0);
-        waddstr(win, (string("Score: ") + to_string(newTile)).c_str());
+        initscr();
+        curs_set(0);
     }
-    else
+
+    ~curses_observer()
     {
-        screen[y][x] = newTile;
-        mvwaddch(win, y+2, x+1, pixValue[newTile]);
+        endwin();
     }
 
-    wrefresh(win);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    void tile(int x, int y, int tile) override
+    {
+        mvaddch(y + 2, x, pixValue[tile]);
+    }
 
-    return;
-}
+    void score(long long score) override
+    {
+        mvaddstr(0, 0, (string("Score: ") + to_string(score)).c_str());
+    }
 
-// Update paddle position based on ball position.
-// The paddle is tracking the ball x position
-long long updatePaddlePos(map<long, vector<int>>* screen)
-{
-    // Find current ball position
-    map<long, vector<int>>& s = *screen;
+    // Only the frames are shown, the tile updates in between are batched
+    void frame(const arcade&) override
+    {
+        refresh();
 
-    int ball_offset_x = 0;
-    int paddle_offset_x = 0;
+        if(framePeriod_ == std::chrono::steady_clock::duration::zero())
+            return;
 
-    for(auto line : s)
-    {
-        for(int i = 0; i < line.second.size(); i++)
-        {
-            if(line.second[i] == TILE_BALL)
-            {
-                ball_offset_x = i;
-            }
-            else if(line.second[i] == TILE_PADDLE)
-            {
-                paddle_offset_x = i;
-            }
-        }
+        // Behind schedule: do not try to catch up
+        auto now = std::chrono::steady_clock::now();
+        if(nextFrame_ < now)
+            nextFrame_ = now;
+
+        std::this_thread::sleep_until(nextFrame_);
+        nextFrame_ += framePeriod_;
     }
-    return myutils::sgn(ball_offset_x - paddle_offset_x);
-}
+};
 
-// Solve puzzle #2
+// Solve puzzle #1
 template <typename T>
-long long solve_puzzle2(T data, int& xmin, int& xmax, int& ymin, int& ymax, bool debug = false)
+long long solve_puzzle1(T data, bool debug = false)
 {
     if(debug)
-    {
-        cout << endl << "Solve puzzle2:" << endl;
-        cout << "xmin: " << xmin << " : xmax :" << xmax << endl;
-        cout << "ymin: " << ymin << " : ymax :" << ymax << endl;
-    }
+        cout << endl << "Solve puzzle1:" << endl;
 
-    Intcode<std::vector<long long>, map<long, vector<int>> > computer(data, 0, false);
+    arcade game(data);
+    game.play();
 
-    computer.setPipeOutputMode(true);
+    if(debug)
+    {
+        cout << "Solution: nbr of tile 2 type: " << game.nbr_blocks() << endl;
 
-    // Initialize screen to EMPTY_TILE tiles
-    map<long, vector<int>> screen;
+        // We dump the screen to stdout
+        for(int y=0; y<game.height(); y++)
+        {
+            string line(game.width(), ' ');
+            for(int x=0; x<game.width(); x++)
+                line[x] = pixValue[game.tile(x, y)];
 
-    for(int y = ymin; y <= ymax; y++)
-    {
-        vector<int> blankLine(xmax - xmin + 1, TILE_EMPTY);
-        screen[y] = blankLine;
+            cout << setw(2) << y << " : " << line << endl;
+        }
     }
 
+    return game.nbr_blocks();
+}
+
+// Solve puzzle #2
+//
+// Headless unless an observer is given: the game runs as fast as the
+// Intcode computer does.
+template <typename T>
+long long solve_puzzle2(T data, arcade_observer* observer = nullptr)
+{
     // Input quarter
-    computer.setMemory(0, 2);
-
-    // Set input callback function for automatic paddle position updating
-    computer.setInputCallbackParam(&screen);
-    computer.setInputCallback(updatePaddlePos);
-
-    // Initialise pixel value for ASCII rendering
-    pixValue[TILE_EMPTY]  = ' ';
-    pixValue[TILE_WALL]   = '#';
-    pixValue[TILE_BLOCK]  = '*';
-    pixValue[TILE_PADDLE] = '=';
-    pixValue[TILE_BALL]   = 'O';
-
-    // Init a curses window for ASCII rendering
-    initscr();
-    start_color();
-    WINDOW *win = newwin(ymax - ymin + 3, xmax - xmin + 3, 2, 2);
-    wborder(win, 0, 0, 0, 0, 0, 0, 0, 0);
-    curs_set(0);
+    arcade game(data, 2, observer);
 
     // Let's paddle
-    while(!computer.isHalted())
-    {
-        int x       = computer.run();
-        int y       = computer.run();
-        int newTile = computer.run();
-
-        refreshScreen(screen, x, y, newTile, win, debug);
-    }
-
-    // Terminate curses
-    endwin();
+    game.play();
 
     // Return the final score
-    return screen[-1][0];
+    return game.score();
 }
 
 int main(int argc, char *argv[])
 {
-    // Need a command-line parameter for the input filename
-    if (argc != 2) {
+    // Need a command-line parameter for the input filename, and optionally
+    // a frame rate to replay the game on screen
+    if (argc != 2 && argc != 3) {
         cerr << "Error: missing input" << endl;
+        cerr << "Usage: " << argv[0] << " input [replay frames per second]" << endl;
         return EXIT_FAILURE;
     }
 
@@ -245,20 +300,25 @@ int main(int argc, char *argv[])
     // Reading the data
     std::vector<long long> data = myutils::read_file_csv<long long, std::vector<long long> >(filename);
 
-    int xmin, xmax, ymin, ymax;
-
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
-    assert(solve_puzzle1(data, xmin, xmax, ymin, ymax, true) == 228 && "Error verifying puzzle #1");
+    assert(solve_puzzle1(data, true) == 228 && "Error verifying puzzle #1");
 
     // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data, xmin, xmax, ymin, ymax, false) << std::endl;
+    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;
 
     // --------- Puzzle #2 ---------
-    assert(solve_puzzle2(data, xmin, xmax, ymin, ymax, true) == 10776 && "Error verifying puzzle #2");
+    assert(solve_puzzle2(data) == 10776 && "Error verifying puzzle #2");
+
+    // Replay the game
+    if(argc == 3)
+    {
+        curses_observer screen(stoi(argv[2]));
+        solve_puzzle2(data, &screen);
+    }
 
     // Solve puzzle #2
-    int sol2 = solve_puzzle2(data, xmin, xmax, ymin, ymax);
+    long long sol2 = solve_puzzle2(data);
     std::cout << "Answer for puzzle #2: "<< sol2 << endl;
 
 }
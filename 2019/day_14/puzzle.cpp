@@ -7,260 +7,195 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
-#include <list>
-#include <map>
+#include <string>
+#include <string_view>
 #include "myutils.h"
-
-#include <sstream>
-#include <algorithm>
-#include <iterator>
+#include "mygraph.h"
 
 using namespace std;
 
-typedef map<string, unsigned long long> Ingredient;
+typedef unsigned __int128 quantity;
 
-typedef struct Reaction
+// Saturated at the largest quantity: the ORE needed stays monotone in the
+// FUEL even when it does not fit
+quantity sat_add(quantity a, quantity b)
 {
-    string     name;
-    unsigned long long  prodMin;
-    unsigned long long  leftOvers;
-    Ingredient input;
-
-   Reaction()
-        : name(""), prodMin(0ull), leftOvers(0ull)
-        {
-            input.clear();
-        }
-
-    Reaction(const Reaction& r)
-        : name(r.name), prodMin(r.prodMin), leftOvers(r.leftOvers), input(r.input)
-        {}
-
-} Reaction;
-
-std::ostream& operator<<(std::ostream& os, const Ingredient& ingredient)
-{
-    for(auto i : ingredient)
-        os << i.second << " " << i.first << " + ";
-    return os;
+    quantity r;
+    return __builtin_add_overflow(a, b, &r) ? ~quantity(0) : r;
 }
 
-std::ostream& operator<<(std::ostream& os, const Reaction& r)
+quantity sat_mul(quantity a, quantity b)
 {
-    return os << r.input << " => " << r.prodMin << " " << r.name ;
+    quantity r;
+    return __builtin_mul_overflow(a, b, &r) ? ~quantity(0) : r;
 }
 
-Reaction
-extractReaction(string& str)
+// Reactions "7 A, 1 B => 1 C". The chemicals are interned, and the edges go
+// from a product to each of its inputs, weighted by the input quantity.
+//
+// In topological order, every consumer of a chemical comes before it: by
+// the time a chemical is reached, its total need is known, and the number
+// of batches is a single ceiling division. One linear pass, no recursion
+// and no leftovers to track.
+class nanofactory
 {
-    Reaction r;
+    myutils::graph::interner names_;
+    myutils::graph::csr_graph<unsigned long long> inputs_;
 
-    std::string delimiter = "=>";
+    // Units produced by one batch, 0 for ORE
+    vector<unsigned long long> batch_;
 
-    // Cleanup: remove possible ',' separator from multiple input ingredients
-    str.erase(std::remove(str.begin(), str.end(), ','), str.end());
+    // Products first
+    vector<int> order_;
 
-    // Find input and output
-    string input  = str.substr(0, str.find(delimiter));
-    string output = str.substr(str.find(delimiter) + delimiter.size(), str.size());
+    int ore_;
+    int fuel_;
 
-    istringstream inputStream(input);
-    istringstream outputStream(output);
-
-    // Output tokens
-    vector<string> tokensOut{
-        istream_iterator<string>{outputStream},
-        istream_iterator<string>{}};
-
-    // Input tokens
-    vector<string> tokensIn{
-        istream_iterator<string>{inputStream},
-        istream_iterator<string>{}};
-
-    if(tokensOut.size() != 2)
+    // "7 A" -> 7, A
+    pair<unsigned long long, int> parse_term(string_view term)
     {
-        cout << ">>>>> Error parsing recipe. Output string: " << output << endl;
-    }
+        auto first = term.find_first_not_of(' ');
+        term.remove_prefix(first);
 
-    // Convert output tokens
-    r.name = tokensOut.back();
-    tokensOut.pop_back();
-    r.prodMin = stoull(tokensOut.back());
+        unsigned long long qty = 0;
+        size_t i = 0;
+        while(i < term.size() && term[i] >= '0' && term[i] <= '9')
+            qty = qty * 10 + (term[i++] - '0');
 
-    // Convert input tokens
-    while(tokensIn.size())
-    {
-        string name;
-        unsigned long long qty;
-
-        name = tokensIn.back();
-        tokensIn.pop_back();
-        qty = stoull(tokensIn.back());
-        tokensIn.pop_back();
+        auto last = term.find_last_not_of(' ');
+        string_view name = term.substr(i + 1, last - i);
 
-        r.input[name] = qty;
+        return {qty, names_.id(name)};
     }
 
-    return r;
-}
+public:
 
-unsigned long long computeNeedeORE(string ingredientName, unsigned long long quantity, map<string, Reaction>& recipe, bool debug = false)
-{
-    unsigned long long neededORE = 0;
-
-    // Find the reaction for this element
-    Reaction mainR = recipe[ingredientName];
-
-    // Find the minimal quantity for this element
-    unsigned long long minqtyOutput = mainR.prodMin;
-
-    if(debug)
-        cout << "computeNeedeORE: need to produce: " << quantity << "  " << mainR.name << " (minimum batch): " << mainR.prodMin << endl;
-
-    if(ingredientName == "ORE")
-        neededORE = quantity;
-    else
+    template <typename T>
+    explicit nanofactory(const T& data)
     {
-        // We ask for quantity of product. The minimum we can produce at a time is minqtyOutput
-        unsigned long long qtyProduce = 0ull;
-        unsigned long long multipleOfMinBatch = 1ull;
+        myutils::graph::csr_builder<unsigned long long> edges;
+        vector<pair<int, unsigned long long>> products;
 
-        // First, check in the leftovers
-        if(recipe[ingredientName].leftOvers >= quantity)
-        {
-            qtyProduce = 0ull;
-            recipe[ingredientName].leftOvers -= quantity;
-        }
-
-        // Need to produce new ingredient
-        else if(quantity <= minqtyOutput)
-        {
-            qtyProduce = minqtyOutput;
-            recipe[ingredientName].leftOvers += qtyProduce - quantity;
-        }
-        else if(quantity % minqtyOutput == 0ull)   // Exact multiple of a minimum batch. No leftovers. Multiply input accordingly
+        for(auto& d : data)
         {
-            multipleOfMinBatch = quantity/minqtyOutput;
-            qtyProduce = multipleOfMinBatch * minqtyOutput;
+            string_view line(d);
+            auto arrow = line.find("=>");
+            if(arrow == string_view::npos)
+                continue;
 
-        }
-        else  // We will have leftovers
-        {
-            multipleOfMinBatch = quantity/minqtyOutput + 1ull;
-            qtyProduce = multipleOfMinBatch * minqtyOutput;
-            recipe[ingredientName].leftOvers += qtyProduce - quantity;
+            auto [batch, product] = parse_term(line.substr(arrow + 2));
+            products.emplace_back(product, batch);
 
-            // Did we overshoot based on available leftovers?
-            if(recipe[ingredientName].leftOvers >= minqtyOutput)
+            string_view in = line.substr(0, arrow);
+            while(!in.empty())
             {
-                recipe[ingredientName].leftOvers -= minqtyOutput;
-                qtyProduce -= minqtyOutput;
-                multipleOfMinBatch--;
+                auto comma = in.find(',');
+                auto [qty, input] = parse_term(in.substr(0, comma));
+                edges.add_edge(product, input, qty);
+
+                in = comma == string_view::npos ? string_view() : in.substr(comma + 1);
             }
         }
 
-        if(debug)
-            cout << "qtyProduce for : " << ingredientName << " : " << qtyProduce << endl;
+        ore_ = names_.id("ORE");
+        fuel_ = names_.id("FUEL");
 
-        if(qtyProduce)
+        batch_.assign(names_.size(), 0);
+        for(auto& [product, batch] : products)
         {
-            // Iterate over list of input
-            for(auto& r : mainR.input)
-            {
-                unsigned long long qtyInput = multipleOfMinBatch * r.second;
-
-                if(debug)
-                    cout << "Input: Need " << qtyInput << "  " << r.first << " batch of: " << r.second << " for : " << qtyProduce << " " << ingredientName << endl;
-
-                neededORE += computeNeedeORE(r.first, qtyInput, recipe);
-            }
+            assert(batch_[product] == 0 && "Chemical produced by two reactions");
+            batch_[product] = batch;
         }
+
+        inputs_ = edges.build(names_.size());
+        order_ = myutils::graph::topological_sort(inputs_);
+        assert((int)order_.size() == names_.size() && "Cyclic reactions");
     }
-    if(debug)
-    {
-        cout << "Element: " << ingredientName << " need " << neededORE << " ORE   .";
-        cout << "Leftovers: " ;
-        for(auto r : recipe)
-            cout << r.first << "=" << r.second.leftOvers << " ";
-        cout << endl;
-    }
-    return neededORE;
-}
 
-// Solve puzzle #1
-template <typename T>
-int solve_puzzle1(T data, int numberOfFuelNeeded = 1, bool debug = false)
-{
-    map<string, Reaction> recipe;  // tuple name : Reaction
-    for(auto s : data)
+    // ORE needed to produce some FUEL
+    quantity ore_for(quantity fuel) const
     {
-        Reaction r = extractReaction(s);
-        recipe[r.name] = r;
-    }
+        vector<quantity> need(names_.size(), 0);
+        need[fuel_] = fuel;
 
-    string basicReaction("1 ORE => 1 ORE");
-    Reaction r = extractReaction(basicReaction);
-    recipe[r.name] = r;
+        for(int u : order_)
+        {
+            if(need[u] == 0 || batch_[u] == 0)
+                continue;
 
-    if(debug)
-    {
-        for(auto r : recipe)
-            cout << "Reaction: " << r.second << endl;
-    }
-    int nbrORE = computeNeedeORE("FUEL", numberOfFuelNeeded, recipe);
+            quantity batches = need[u] / batch_[u] + (need[u] % batch_[u] != 0);
 
-    if(debug)
-        cout << "Number of ORE needed: " << nbrORE << endl;
+            for(auto& e : inputs_.neighbors(u))
+                need[e.to] = sat_add(need[e.to], sat_mul(batches, e.weight));
+        }
 
-    return nbrORE;
-}
+        return need[ore_];
+    }
 
-// Solve puzzle #2
-template <typename T>
-unsigned long long solve_puzzle2(T data, bool debug = false)
-{
-    // Extract all reactions
-    map<string, Reaction> recipe;  // tuple name : Reaction
-    for(auto s : data)
+    // ORE per FUEL, when the batches can be split: a lower bound of
+    // ore_for(fuel) / fuel
+    long double ore_rate() const
     {
-        Reaction r = extractReaction(s);
-        recipe[r.name] = r;
-    }
+        vector<long double> need(names_.size(), 0);
+        need[fuel_] = 1;
 
-    string basicReaction("1 ORE => 1 ORE");
-    Reaction r = extractReaction(basicReaction);
-    recipe[r.name] = r;
+        for(int u : order_)
+        {
+            if(batch_[u] == 0)
+                continue;
 
-    unsigned long long cargo = 1000000000000ull;
-    unsigned long long numberOfFuelProduced = 0ull;
-    unsigned long long production = 0ull;
+            for(auto& e : inputs_.neighbors(u))
+                need[e.to] += need[u] * e.weight / batch_[u];
+        }
 
-    // Rapidely find the nearest block of 100000, then slice this bracket by 10, until we converge to a unit bracket
-    unsigned long long bracket = 100000ull;
+        return need[ore_];
+    }
 
-    do
+    // Most FUEL produced from the ORE budget
+    //
+    // Whole batches only waste ORE: ore_for(n) <= n * ore_for(1), so
+    // budget / ore_for(1) is feasible. Split batches waste nothing:
+    // ore_for(n) >= n * ore_rate(), so budget / ore_rate() + 1 is not.
+    // Binary search in between, ore_for is monotone.
+    unsigned long long max_fuel(unsigned long long budget) const
     {
-        production = 0ull;
+        quantity orePerFuel = ore_for(1);
+        if(orePerFuel == 0 || orePerFuel > budget)
+            return 0;
 
-        while(production <= cargo)
-        {
-            numberOfFuelProduced += bracket;
-            production = computeNeedeORE("FUEL", numberOfFuelProduced, recipe);
+        quantity lo = budget / orePerFuel;
 
-            if(debug)
-                cout << numberOfFuelProduced << " FUEL will need: " << production << " ORE" << endl;
-        }
+        // Guard against the rounding of the rate
+        quantity hi = (quantity)(budget / ore_rate()) + 2;
+        while(ore_for(hi) <= budget)
+            hi = sat_mul(hi, 2);
 
-        // We've exceed the current bracket, moving back one bracket, and using a smaller bracket
-        numberOfFuelProduced -= bracket;
-        bracket /= 10ull;
+        // ore_for(lo) <= budget < ore_for(hi)
+        while(hi - lo > 1)
+        {
+            quantity mid = lo + (hi - lo) / 2;
+            if(ore_for(mid) <= budget)
+                lo = mid;
+            else
+                hi = mid;
+        }
 
-    } while(bracket >= 1ull);
+        return lo;
+    }
+};
 
-    if(debug)
-        cout << "Number of Fuel produced: " << numberOfFuelProduced << endl;
+// Solve puzzle #1
+template <typename T>
+unsigned long long solve_puzzle1(T data, unsigned long long numberOfFuelNeeded = 1)
+{
+    return nanofactory(data).ore_for(numberOfFuelNeeded);
+}
 
-    return numberOfFuelProduced;
+// Solve puzzle #2
+template <typename T>
+unsigned long long solve_puzzle2(T data, unsigned long long cargo = 1000000000000ull)
+{
+    return nanofactory(data).max_fuel(cargo);
 }
 
 int main(int argc, char *argv[])
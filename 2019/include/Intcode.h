@@ -6,27 +6,25 @@
 
 #include <vector>
 #include <stack>
-#include <sstream>
-#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include "myinstrument.h"
 
 using namespace std;
 
 #ifndef INTCODE_H
 #define INTCODE_H
 
-typedef std::vector<int> paramMode;
-static const int MAX_NBR_PARAM = 3;
+static constexpr int MAX_NBR_PARAM = 3;
 
-std::ostream& operator<<(std::ostream& os, const paramMode& p)
-{
-    for(int i=0; i<MAX_NBR_PARAM; i++)
-    {
-        os << p[MAX_NBR_PARAM - i - 1];
-    }
-    return os;
-}
+// The debug traces are compiled in only with -DINTCODE_DEBUG: otherwise the
+// debug flag given to the constructor is ignored, and the interpreter loop
+// carries no test for it.
+#ifdef INTCODE_DEBUG
+#define INTCODE_TRACE(stmt) do { if(debug_) { stmt; } } while(0)
+#else
+#define INTCODE_TRACE(stmt) do {} while(0)
+#endif
 
 template <class T = std::vector<long long>, class C = int>
 class Intcode
@@ -80,7 +78,7 @@ private:
     long long ip_;
 
     // Current instruction parameter mode
-    paramMode paramMode_;
+    int paramMode_[MAX_NBR_PARAM];
 
     // Input
     stack<long long> input_;  // Allow multiple inputs
@@ -109,38 +107,21 @@ private:
     // Debug mode
     bool debug_;
 
-    long long extractParamMode(long long& opCode)
+    // Decode the ABCDE instruction: the modes are the digits C, B and A,
+    // and missing digits are POSITION (0)
+    long long extractParamMode(long long instruction)
     {
-        int paramModeVal = opCode / 100;
-
-        // Convert paramModeVal into a leading zero string 001
-        std::stringstream ss;
-        ss << std::setw(MAX_NBR_PARAM) << std::setfill('0') << paramModeVal;
-        std::string s = ss.str();
-
-        // Move info into paramMode vector
-        paramMode_[0] = s[2] - '0';
-        paramMode_[1] = s[1] - '0';
-        paramMode_[2] = s[0] - '0';
+        paramMode_[PARAM1] = (instruction / 100) % 10;
+        paramMode_[PARAM2] = (instruction / 1000) % 10;
+        paramMode_[PARAM3] = (instruction / 10000) % 10;
 
-        opCode %= 100;
-
-        return opCode;
-    }
-
-    // Reset parameter mode to POSITION
-    void resetParamMode()
-    {
-        paramMode_.clear();
-        for(int i=0; i<MAX_NBR_PARAM; i++)
-            paramMode_.push_back(POSITION);
+        return instruction % 100;
     }
 
     // Extract parameter value base on current paramMode
     long long extractParamIndex(long long initialParamValue, paramIndex index)
     {
-        if(debug_)
-            cout << "Inside extractParamIndex: ip_: " << ip_ << endl;
+        INTCODE_TRACE(cout << "Inside extractParamIndex: ip_: " << ip_ << endl);
 
         long long paramIndex = initialParamValue;
 
@@ -148,26 +129,21 @@ private:
         {
             case POSITION:
             {
-                if(debug_)
-                    cout << "Param: " << index << ": mode : POSITION: " << " : memory_[" << initialParamValue << "]" << ": " << memory_[initialParamValue] << endl;
+                INTCODE_TRACE(cout << "Param: " << index << ": mode : POSITION: " << " : memory_[" << initialParamValue << "]" << ": " << memory_[initialParamValue] << endl);
                 // Do nothing, the parameter already specify the proper index
             }
             break;
             case IMMEDIATE:
             {
-                if(debug_)
-                    cout << "Param: " << index << ": IMMEDIATE: " << initialParamValue << endl;
+                INTCODE_TRACE(cout << "Param: " << index << ": IMMEDIATE: " << initialParamValue << endl);
 
                 paramIndex = ip_-1;
             }
             break;
             case RELATIVE:
             {
-                if(debug_)
-                {
-                    cout << "Param: " << index << ": RELATIVE: " << initialParamValue <<  ": tot. offset: " << initialParamValue + relBase_
-                        << " : memory_[" << initialParamValue + relBase_ << "]" << ": "<< memory_[initialParamValue + relBase_] << endl;
-                }
+                INTCODE_TRACE(cout << "Param: " << index << ": RELATIVE: " << initialParamValue <<  ": tot. offset: " << initialParamValue + relBase_
+                    << " : memory_[" << initialParamValue + relBase_ << "]" << ": "<< memory_[initialParamValue + relBase_] << endl);
                 paramIndex = initialParamValue + relBase_;
             }
             break;
@@ -186,7 +162,7 @@ public:
     Intcode (T& initState, long long input, bool debug = false)
         : memory_(initState),
           ip_(0),
-          paramMode_(MAX_NBR_PARAM),
+          paramMode_{POSITION, POSITION, POSITION},
           output_(0),
           pipeMode_(false),
           runState_(RUNNING),
@@ -205,7 +181,7 @@ public:
     Intcode (T& initState, T input, bool debug = false)
         : memory_(initState),
           ip_(0),
-          paramMode_(MAX_NBR_PARAM ),
+          paramMode_{POSITION, POSITION, POSITION},
           output_(0),
           pipeMode_(false),
           runState_(RUNNING),
@@ -225,8 +201,7 @@ public:
     {
         pipeMode_ = pMode;
 
-        if(debug_)
-            cout << "pipeMode: " << pipeMode_ << endl;
+        INTCODE_TRACE(cout << "pipeMode: " << pipeMode_ << endl);
     }
 
     void setInput(T input)
@@ -243,27 +218,21 @@ public:
     // Run the current program state
     long long run()
     {
+        AOC_TIMER("intcode.run");
+
         long long opCode = 0;  // opCode
 
         while(opCode != HALT && opCode != FEEDTHEPIPE)
         {
-            if(debug_)
-                cout << "ip_: " << ip_ << " ---- ";
-
-            // Reset parameter mode to POSITION
-            resetParamMode();
+            AOC_COUNT("intcode.instructions");
 
-            // Next opcode
-            opCode = memory_[ip_++];
+            INTCODE_TRACE(cout << "ip_: " << ip_ << " ---- ");
 
-            if(opCode > 100)
-            {
-                // We have some parameter in immediate mode
-                opCode = extractParamMode(opCode);
-            }
+            // Next opcode, and its parameter modes
+            opCode = extractParamMode(memory_[ip_++]);
 
-            if(debug_)
-                cout << "opcode: " << opCode << " - paramMode: " << paramMode_ << endl;
+            INTCODE_TRACE(cout << "opcode: " << opCode << " - paramMode: "
+                << paramMode_[PARAM3] << paramMode_[PARAM2] << paramMode_[PARAM1] << endl);
 
             switch (opCode)
             {
@@ -297,8 +266,7 @@ public:
 
                         memory_[indexParam1] = input_.top();
 
-                        if(debug_)
-                            cout << "INPUT:: value: " << input_.top() << " at index: " << indexParam1 << endl;
+                        INTCODE_TRACE(cout << "INPUT:: value: " << input_.top() << " at index: " << indexParam1 << endl);
 
                         input_.pop();
                     }
@@ -322,8 +290,7 @@ public:
                     // Check param mode
                     long long indexParam1 = extractParamIndex(memory_[ip_++], PARAM1);
 
-                    if(debug_)
-                        cout << "OUTPUT: indexParam1: " << indexParam1 << endl;
+                    INTCODE_TRACE(cout << "OUTPUT: indexParam1: " << indexParam1 << endl);
 
                     output_ = memory_[indexParam1];
 
@@ -335,12 +302,9 @@ public:
                         // We stop at the current instruction pointer
                     }
 
-                    if(debug_)
-                    {
-                        std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>  Output: "
+                    INTCODE_TRACE(std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>  Output: "
                         << output_
-                        << std::endl;
-                    }
+                        << std::endl);
                 }
                 break;
 
@@ -399,16 +363,12 @@ public:
                     // Check param mode
                     long long indexParam1 = extractParamIndex(memory_[ip_++], PARAM1);
 
-                    if(debug_)
-                    {
-                        cout << "indexParam1: " << indexParam1 << endl;
-                        cout << "relBase_ old value: " << relBase_ << endl;
-                    }
+                    INTCODE_TRACE(cout << "indexParam1: " << indexParam1 << endl;
+                                  cout << "relBase_ old value: " << relBase_ << endl);
 
                     relBase_ += memory_[indexParam1];
 
-                    if(debug_)
-                        cout << "relBase_ new value: " << relBase_ << endl;
+                    INTCODE_TRACE(cout << "relBase_ new value: " << relBase_ << endl);
                 }
                 break;
 
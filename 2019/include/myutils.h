@@ -15,6 +15,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <math.h>
+#include <type_traits>
 
 namespace myutils
 {
@@ -27,17 +28,25 @@ auto read_file(const std::string filename, bool keepSpaces=false, const bool deb
 
         std::ifstream file(filename);
 
-        if(keepSpaces)
+        bool linesRead = false;
+
+        // Whole lines only make sense for a container of strings
+        if constexpr (std::is_same<typename T_container::value_type, std::string>::value)
         {
-            while(file.good())
+            if(keepSpaces)
             {
-                std::string line;
-                getline(file, line);
-                if(line.size() > 0)
-                    buffer.push_back(line);
+                while(file.good())
+                {
+                    std::string line;
+                    getline(file, line);
+                    if(line.size() > 0)
+                        buffer.push_back(line);
+                }
+                linesRead = true;
             }
         }
-        else
+
+        if(!linesRead)
         {
             std::copy(
                 std::istream_iterator<T_value>(file),
@@ -8,60 +8,20 @@
 #include <cassert>
 #include <vector>
 #include <sstream>
-#include <map>
-#include <set>
 #include <regex>
 #include "myutils.h"
+#include "mygraph.h"
 
 using namespace std;
 
-typedef std::tuple<int, string> Bags;
-typedef std::multimap<string, Bags> bagRegulations;
-typedef std::multimap<string, string> containedBy;
-typedef bagRegulations::iterator bIterator;
-typedef containedBy::iterator cIterator;
+// Bag rules: an edge container -> content, weighted by the number of bags
+typedef myutils::graph::csr_graph<int> bagRegulations;
 
-std::ostream& operator<<(std::ostream& os, const Bags& b)
-{
-    return os << "|" <<std::get<0>(b)
-        << "|"
-        << std::get<1>(b)
-        << "|";
-}
-
-int traverseContained(containedBy &contained, string& colour, set<string>& resultSet)
-{
-    resultSet.insert(colour);
-
-    std::pair<cIterator, cIterator> result = contained.equal_range(colour);
-
-    for (cIterator it = result.first; it != result.second; it++)
-    {
-        resultSet.insert(it->second);
-
-        traverseContained(contained, it->second, resultSet);
-    }
-
-    return resultSet.size();
-
-}
-
-int
-countMyBags(bagRegulations& bagReg, string& colour)
-{
-    int nbrBags = 0;
-
-    std::pair<bIterator, bIterator> result = bagReg.equal_range(colour);
-
-    for (bIterator it = result.first; it != result.second; it++)
-        nbrBags += std::get<0>(it->second) * (1 + countMyBags(bagReg, std::get<1>(it->second)));
-
-    return nbrBags;
-
-}
 template <typename T>
-void processBagRules(T& data, bagRegulations& reg, containedBy &contained)
+bagRegulations processBagRules(T& data, myutils::graph::interner& colours)
 {
+    myutils::graph::csr_builder<int> rules;
+
     for(auto d : data)
     {
         if(!d.empty())
@@ -70,6 +30,11 @@ void processBagRules(T& data, bagRegulations& reg, containedBy &contained)
             string containerBag = d.substr(0, d.find(splitEntry));
             string content = d.substr(d.find(splitEntry) + splitEntry.length());
 
+            int container = colours.id(containerBag);
+
+            if(content.compare(0, 8, "no other") == 0)
+                continue;
+
             // Remove " bag", " bags" junk
             content = std::regex_replace (content, std::regex("\\b( bag)([ s.]*)"), "");
             content = std::regex_replace (content, std::regex(",  "), ",");
@@ -90,42 +55,54 @@ void processBagRules(T& data, bagRegulations& reg, containedBy &contained)
                 if(colour.find(' ') == 0)
                     colour.erase(0, 1);
 
-                // Memorize container/content mmap
-                Bags b = std::make_tuple(nbr, colour);
-                reg.insert({containerBag, b});
-
-                // Memorize contained/container mmap
-                contained.insert({colour, containerBag});
+                rules.add_edge(container, colours.id(colour), nbr);
             }
         }
     }
+
+    return rules.build(colours.size());
 }
 
 // Solve puzzle #1
 template <typename T>
 int solve_puzzle1(T& data)
 {
-    bagRegulations reg;
-    containedBy    contained;
-    string initColour("shiny gold");
-    set<string> resultSet;
+    myutils::graph::interner colours;
+    bagRegulations reg = processBagRules(data, colours);
 
-    processBagRules(data, reg, contained);
+    int shinyGold = colours.find("shiny gold");
+    if(shinyGold < 0)
+        return 0;
 
-    return traverseContained(contained, initColour, resultSet) - 1; // Remove the shiny gold envelope
+    // Every bag reaching shiny gold, through the contained -> container edges
+    int nbrContainers = 0;
+    myutils::graph::dfs(reg.reversed(), shinyGold, [&nbrContainers](int){ nbrContainers++; });
+
+    return nbrContainers - 1; // Remove the shiny gold envelope
 }
 
 // Solve puzzle #2
 template <typename T>
-constexpr int solve_puzzle2(T data)
+int solve_puzzle2(T data)
 {
-    bagRegulations reg;
-    containedBy    contained;
-    string initColour("shiny gold");
+    myutils::graph::interner colours;
+    bagRegulations reg = processBagRules(data, colours);
+
+    int shinyGold = colours.find("shiny gold");
+    if(shinyGold < 0)
+        return 0;
 
-    processBagRules(data, reg, contained);
+    // Number of bags inside each bag, each bag computed once
+    auto nbrInside = myutils::graph::dag_fold<long>(reg,
+        [&reg](int bag, const vector<long>& inside)
+        {
+            long nbrBags = 0;
+            for(auto& content : reg.neighbors(bag))
+                nbrBags += content.weight * (1 + inside[content.to]);
+            return nbrBags;
+        });
 
-    return countMyBags(reg, initColour);
+    return nbrInside[shinyGold];
 }
 
 
@@ -11,11 +11,14 @@
 #include <sstream>      // std::stringstream
 #include <climits>
 #include "myutils.h"
+#include "myinstrument.h"
 
 using namespace std;
 
 long growthSingleFish(int t0, int timeMax)
 {
+    AOC_COUNT("growthSingleFish.calls");
+
     long popFromThisFish = 0;
 
     for(int t = t0+1; t<=timeMax; t += 7)
@@ -29,8 +32,10 @@ long growthSingleFish(int t0, int timeMax)
 
 // Solve puzzle #1
 template <typename T>
-constexpr long solve_puzzle1(T data, int timeMax)
+long solve_puzzle1(T data, int timeMax)
 {
+    AOC_TIMER("solve_puzzle1");
+
     vector<unsigned char> fishes(0);
 
     std::stringstream ss(data[0]);
@@ -53,6 +58,7 @@ constexpr long solve_puzzle1(T data, int timeMax)
 
         if(cacheComputation.find(f) == cacheComputation.end())
         {
+            AOC_TIMER("growthSingleFish");
             nbrKids = growthSingleFish(f, timeMax);
             cacheComputation[f] = nbrKids;
         }
@@ -90,7 +96,10 @@ int main(int argc, char *argv[])
 
     // Reading the data
     vector<string> data;
-    myutils::read_file(data, filename, true, false);
+    {
+        AOC_TIMER("parse");
+        myutils::read_file(data, filename, true, false);
+    }
 
     // --------- Puzzle #1 ---------
     // Verify puzzle1 examples
@@ -11,14 +11,20 @@
 #include <set>
 #include <sstream>      // std::stringstream
 #include <algorithm>
+#include <cstddef>
 #include "myutils.h"
+#include "myarena.h"
 
 using namespace std;
 
-set<char>
-convertToSet(string s)
+// The segment sets are allocated from the memory resource given to
+// findSegmentsMapping: the per-entry arena of solve_puzzle2
+typedef myutils::pmr::set<char> segmentSet;
+
+segmentSet
+convertToSet(const string& s, std::pmr::memory_resource* mem)
 {
-    set<char> retValue;
+    segmentSet retValue(mem);
     for(auto c: s)
     {
         retValue.insert(c);
@@ -27,7 +33,7 @@ convertToSet(string s)
 }
 
 string
-convertToString(set<char> s)
+convertToString(const segmentSet& s)
 {
     string retValue;
     for(auto c : s)
@@ -38,33 +44,34 @@ convertToString(set<char> s)
 }
 
 void
-findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
+findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing, std::pmr::memory_resource* mem)
 {
-    map<int, set<char> > segments;
+    // The map hands its resource down to the sets it holds
+    myutils::pmr::map<int, segmentSet> segments(mem);
 
     // Find mapping for simpler digits '1', '4', '7' and '8'
     for(auto t : tests)
     {
         if(t.size() == 2)
         {
-            segments[1] = convertToSet(t);  // 1
+            segments[1] = convertToSet(t, mem);  // 1
         }
         else if(t.size() == 4)
         {
-            segments[4] = convertToSet(t);  // 4
+            segments[4] = convertToSet(t, mem);  // 4
         }
         else if(t.size() == 3)
         {
-            segments[7] = convertToSet(t);  // 7
+            segments[7] = convertToSet(t, mem);  // 7
         }
         else if(t.size() == 7)
         {
-            segments[8] = convertToSet(t);  // 8
+            segments[8] = convertToSet(t, mem);  // 8
         }
     }
 
     // Cleanup
-    for(auto seg : segments)
+    for(const auto& seg : segments)
     {
         tests.erase(std::remove(tests.begin(), tests.end(), convertToString(seg.second)), tests.end());
     }
@@ -73,11 +80,11 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
     // - only one segment different with digit '8'
     // - and none in common with digit '1' and '4' -- 9
     // - else this is '0'
-    set<char> segs8 = segments[8];
-    set<char> s_diff_8_vs_9;
+    segmentSet segs8(segments[8], mem);
+    segmentSet s_diff_8_vs_9(mem);
     for(auto t: tests)
     {
-        set<char> curSet = convertToSet(t);
+        segmentSet curSet = convertToSet(t, mem);
 
         s_diff_8_vs_9.clear();
 
@@ -97,12 +104,12 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
                 segments[4].find(*(s_diff_8_vs_9.begin())) == segments[4].end()
             )
             {
-                segments[9] = convertToSet(t);  // 9
+                segments[9] = convertToSet(t, mem);  // 9
                 // cout << "Found 9: "  << convertToString(segments[9]) << endl;
             }
             else  // this is digit '0'
             {
-                segments[0] = convertToSet(t);  // 0
+                segments[0] = convertToSet(t, mem);  // 0
                 // cout << "Found 0: "  << convertToString(segments[0]) << endl;
             }
             //break;
@@ -119,7 +126,7 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
     {
         if(t.size() == 6)
         {
-            segments[6] = convertToSet(t);  // 6
+            segments[6] = convertToSet(t, mem);  // 6
             // cout << "Found 6: "  << convertToString(segments[6]) << endl;
         }
     }
@@ -130,8 +137,8 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
     // -- Only remaining digit with common segments with all segment from digit '1'
     for(auto t : tests)
     {
-        set<char> curSet = convertToSet(t);
-        set<char> s_common;
+        segmentSet curSet = convertToSet(t, mem);
+        segmentSet s_common(mem);
 
         std::set_intersection
             (
@@ -142,7 +149,7 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
 
         if(s_common.size() == 2)
         {
-            segments[3] = convertToSet(t);  // 3
+            segments[3] = convertToSet(t, mem);  // 3
             // cout << "Found 3: "  << convertToString(segments[3]) << endl;
         }
     }
@@ -154,8 +161,8 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
     // - Only one with 5 segments in common with '6'
     for(auto t : tests)
     {
-        set<char> curSet = convertToSet(t);
-        set<char> s_common;
+        segmentSet curSet = convertToSet(t, mem);
+        segmentSet s_common(mem);
 
         s_common.clear();
 
@@ -168,12 +175,12 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
 
         if(s_common.size() == 5)
         {
-            segments[5] = convertToSet(t);  // 5
+            segments[5] = convertToSet(t, mem);  // 5
             // cout << "Found 5: "  << convertToString(segments[5]) << endl;
         }
         else
         {
-            segments[2] = convertToSet(t);  // 2
+            segments[2] = convertToSet(t, mem);  // 2
             // cout << "Found 2: "  << convertToString(segments[2]) << endl;
         }
     }
@@ -195,7 +202,7 @@ findSegmentsMapping(vector<string> tests, map<string, int>& segmentPairing)
     }
 
     // Return reverse map : scrambled string to digit
-    for(auto seg : segments)
+    for(const auto& seg : segments)
     {
         segmentPairing[convertToString(seg.second)] = seg.first;
     }
@@ -330,10 +337,15 @@ constexpr int solve_puzzle2(T data)
     long sumDigits = 0;
     for(auto l: listTests)
     {
+        // Temporary sets of this entry: a pointer bump in a stack buffer,
+        // released in one shot
+        std::byte buffer[4096];
+        myutils::arena arena(buffer, sizeof(buffer));
+
         string fullDigit;
         map<string, int> sevenSegmentMap;
 
-        findSegmentsMapping(l.first, sevenSegmentMap);
+        findSegmentsMapping(l.first, sevenSegmentMap, &arena);
 
         // Dump digits
         for(auto s : l.second)
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <functional>
 #include <vector>
 #include <set>
 #include <sstream>      // std::stringstream
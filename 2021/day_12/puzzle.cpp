@@ -6,18 +6,21 @@
 
 #include <iostream>
 #include <cassert>
+#include <functional>
 #include <vector>
-#include <map>
 #include <sstream>      // std::stringstream
 #include "myutils.h"
+#include "mygraph.h"
 
 using namespace std;
 
 // Solve puzzle #1
 template <typename T>
-constexpr int solve_puzzle1(T data, bool revisitSmallCave, int debug = 0)
+int solve_puzzle1(T data, bool revisitSmallCave, int debug = 0)
 {
-    multimap<string, string> tree;
+    myutils::graph::interner caves;
+    myutils::graph::csr_builder<int> passages;
+
     for(auto s : data)
     {
         std::stringstream ss(s);
@@ -26,110 +29,68 @@ constexpr int solve_puzzle1(T data, bool revisitSmallCave, int debug = 0)
         std::getline(ss, token1, '-');
         std::getline(ss, token2, '-');
 
-        tree.insert(pair <string, string> (token1, token2));
-        tree.insert(pair <string, string> (token2, token1));
+        passages.add_undirected_edge(caves.id(token1), caves.id(token2));
 
         if(debug)
             cout << "Tokens: " << token1 << " --- " << token2 << endl;
     }
 
-    if(debug)
+    const auto tree = passages.build(caves.size());
+
+    const int start = caves.find("start");
+    const int end   = caves.find("end");
+
+    if(start < 0 || end < 0)
+        return 0;
+
+    // Big caves are all uppercase
+    vector<bool> isBigCave(caves.size());
+    for(int c=0; c<caves.size(); c++)
     {
-        for(auto t: tree)
-        {
-            cout << "Tree[" << t.first << "]: " << t.second << endl;
-        }
+        const string& name = caves.name(c);
+        isBigCave[c] = find_if(name.begin(), name.end(), [](char c){return islower(c); }) == name.end();
     }
 
-    // lambda function: is string all uppercase?
-    auto isUpperCase = [](string &s) ->bool {
-        return find_if(s.begin(), s.end(), [](char c){return islower(c); }) == s.end();
-    };
+    // Number of visits of each cave on the current path
+    vector<int> nbrVisits(caves.size(), 0);
 
-    // lambda function: count number of occurences for 'entry' in vector 'v'
-    auto countNumberOfEntry = [](vector<string> &v, string entry) ->int {
-        int nbrEntry = 0;
-        for(auto e: v)
+    // Recursive lambda function: number of paths to 'end' from node
+    std::function<int(int, bool)> countPaths;
+    countPaths = [&](int node, bool revisitSmallCave)->int
         {
-            if(e == entry)
-            {
-                nbrEntry++;
-            }
-        }
-        return nbrEntry;
-    };
+            if(debug)
+                cout << "Adding node: " << caves.name(node) << endl;
 
+            if(node == end)
+                return 1;
 
-    // Recursive lambda function: add node to path and recurse from there
-    std::function<void(string, vector<string>, bool, int&)> addNode;
-    addNode = [
-        &tree,
-        &isUpperCase,
-        &countNumberOfEntry,
-        debug,
-        &addNode](string node, vector<string> path, bool revisitSmallCave, int& nbrValidPaths)->void
-        {
-            if(debug)
-                cout << "Adding node: " << node << endl;
+            int nbrValidPaths = 0;
 
-            path.push_back(node);
+            nbrVisits[node]++;
 
-            if(node != "end" && node != "start")
+            for(auto& next : tree.neighbors(node))
             {
-                auto nextNodes = tree.equal_range(node);
+                if(next.to == start)
+                    continue;
 
-                for(auto it = nextNodes.first; it != nextNodes.second; it++)
+                if(isBigCave[next.to] || nbrVisits[next.to] == 0)
                 {
-                    // No more than 2 visits to only one small cave
-                    if(
-                        revisitSmallCave &&
-                        !isUpperCase(node) &&
-                        countNumberOfEntry(path, node) == 2
-                    )
-                    {
-                        revisitSmallCave = false;
-                    }
-
-                    if(
-                        find(path.begin(), path.end(), it->second) == path.end() ||
-                        revisitSmallCave ||
-                        isUpperCase(it->second)
-                    )
-                    {
-                        addNode(it->second, path, revisitSmallCave, nbrValidPaths);
-                    }
+                    nbrValidPaths += countPaths(next.to, revisitSmallCave);
                 }
-            }
-            else if(node == "end")
-            {
-                nbrValidPaths++;
-
-                if(debug)
+                else if(revisitSmallCave)
                 {
-                    cout << "New path: ";
-                    for(auto p : path)
-                    {
-                        cout << p << ',';
-                    }
-                    cout << endl;
+                    // No more than 2 visits to only one small cave
+                    nbrValidPaths += countPaths(next.to, false);
                 }
             }
-        };
 
-    // Start at 'start'
-    auto node = tree.equal_range("start");
+            nbrVisits[node]--;
 
-    int nbrValidPaths = 0;
-    for(auto it = node.first; it != node.second; it++)
-    {
-        if(debug)
-            cout << it->first << "-" << it->second << endl;
+            return nbrValidPaths;
+        };
 
-        vector<string> path;
-        path.push_back(it->first);
-        addNode(it->second, path, revisitSmallCave, nbrValidPaths);
-    }
-    return nbrValidPaths;
+    // Start at 'start'
+    return countPaths(start, revisitSmallCave);
 }
 
 int main(int argc, char *argv[])
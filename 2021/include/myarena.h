@@ -0,0 +1,152 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// Arena allocator for the per-solve temporary data.
+//
+// myutils::arena is a monotonic buffer (std::pmr): allocations are a pointer
+// bump, deallocations are no-ops, and everything is released at once when the
+// arena goes out of scope.  Use it with the myutils::pmr container aliases:
+//
+//    myutils::arena arena;
+//    myutils::pmr::vector<myutils::pmr::string> names(arena);
+//
+// Beware: copy-constructing a pmr container uses the *default* resource, not
+// the one of the source.  Prefer giving the arena explicitly to the copies:
+//
+//    myutils::pmr::vector<int> copy(source, &arena);
+//
+// scoped_default_resource installs the arena as the default resource
+// instead.  That default is process-wide: while installed, every pmr
+// allocation of every thread not given a resource goes to the arena.  Only
+// use it around single-threaded code that cannot take the resource.
+//
+// Not thread-safe: one arena per thread.
+
+#ifndef MYARENA_H
+#define MYARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace myutils
+{
+    class arena : public std::pmr::memory_resource
+    {
+        std::pmr::monotonic_buffer_resource buffer_;
+
+        // Statistics
+        std::size_t bytesAllocated_;
+        std::size_t nbrAllocations_;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            bytesAllocated_ += bytes;
+            nbrAllocations_++;
+
+            return buffer_.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override
+        {
+            // Monotonic: released all at once
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    public:
+
+        // initialSize: size of the first block requested from upstream, the
+        // next ones grow geometrically.
+        explicit arena(
+            std::size_t initialSize = 64*1024,
+            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+        )
+            : buffer_(initialSize, upstream),
+              bytesAllocated_(0),
+              nbrAllocations_(0)
+        {}
+
+        // Use a caller-provided buffer first (ie: on the stack)
+        arena(void* buffer, std::size_t bufferSize,
+              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : buffer_(buffer, bufferSize, upstream),
+              bytesAllocated_(0),
+              nbrAllocations_(0)
+        {}
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        // Release everything. The containers using the arena must be gone.
+        void release()
+        {
+            buffer_.release();
+            bytesAllocated_ = 0;
+            nbrAllocations_ = 0;
+        }
+
+        std::size_t bytes_allocated() const { return bytesAllocated_; }
+        std::size_t nbr_allocations() const { return nbrAllocations_; }
+    };
+
+    // Install a memory resource as the default one for the current scope
+    class scoped_default_resource
+    {
+        std::pmr::memory_resource* previous_;
+
+    public:
+        explicit scoped_default_resource(std::pmr::memory_resource& r)
+            : previous_(std::pmr::set_default_resource(&r))
+        {}
+
+        ~scoped_default_resource()
+        {
+            std::pmr::set_default_resource(previous_);
+        }
+
+        scoped_default_resource(const scoped_default_resource&) = delete;
+        scoped_default_resource& operator=(const scoped_default_resource&) = delete;
+    };
+
+    // Container aliases allocating from a std::pmr::memory_resource
+    namespace pmr
+    {
+        using string = std::pmr::string;
+
+        template <typename T>
+        using vector = std::pmr::vector<T>;
+
+        template <typename T>
+        using deque = std::pmr::deque<T>;
+
+        template <typename K, typename Compare = std::less<K>>
+        using set = std::pmr::set<K, Compare>;
+
+        template <typename K, typename V, typename Compare = std::less<K>>
+        using map = std::pmr::map<K, V, Compare>;
+
+        template <typename K, typename V, typename Compare = std::less<K>>
+        using multimap = std::pmr::multimap<K, V, Compare>;
+
+        template <typename K, typename Hash = std::hash<K>>
+        using unordered_set = std::pmr::unordered_set<K, Hash>;
+
+        template <typename K, typename V, typename Hash = std::hash<K>>
+        using unordered_map = std::pmr::unordered_map<K, V, Hash>;
+    }
+}
+
+#endif  // MYARENA_H
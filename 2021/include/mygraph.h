@@ -0,0 +1,296 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// Graph helpers for the string-keyed puzzles.
+//
+// - interner: maps the node names to dense ids 0..n-1, once, at parse time
+// - csr_graph: compressed sparse row adjacency, built from an edge list
+// - bfs_distances, dfs, topological_sort, dag_fold
+//
+// The traversals then only deal with ints and contiguous arrays: no string
+// compares and no tree lookups in the hot loops.
+//
+//    myutils::graph::interner names;
+//    myutils::graph::csr_builder<int> edges;
+//    edges.add_edge(names.id("shiny gold"), names.id("dark red"), 2);
+//    ...
+//    auto g = edges.build(names.size());
+//    for(auto& e : g.neighbors(u)) ... e.to, e.weight
+
+#ifndef MYGRAPH_H
+#define MYGRAPH_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+namespace myutils
+{
+namespace graph
+{
+    // Name <-> dense id
+    class interner
+    {
+        // deque: stable addresses, the map keys are views on these strings
+        std::deque<std::string> names_;
+        std::unordered_map<std::string_view, int> ids_;
+
+    public:
+
+        // Id of name, added if new
+        int id(std::string_view name)
+        {
+            auto it = ids_.find(name);
+            if(it != ids_.end())
+                return it->second;
+
+            int newId = names_.size();
+            names_.emplace_back(name);
+            ids_.emplace(names_.back(), newId);
+
+            return newId;
+        }
+
+        // Id of name, or -1 if unknown
+        int find(std::string_view name) const
+        {
+            auto it = ids_.find(name);
+            return it == ids_.end() ? -1 : it->second;
+        }
+
+        const std::string& name(int id) const
+        {
+            return names_[id];
+        }
+
+        int size() const
+        {
+            return names_.size();
+        }
+    };
+
+    template <typename W>
+    struct edge
+    {
+        int to;
+        W weight;
+    };
+
+    // Adjacency in compressed sparse row layout: the out-edges of node u are
+    // edges_[offsets_[u]] .. edges_[offsets_[u+1]-1]
+    template <typename W = int>
+    class csr_graph
+    {
+        std::vector<int> offsets_;
+        std::vector<edge<W>> edges_;
+
+        template <typename> friend class csr_builder;
+
+    public:
+
+        // Contiguous range of edges
+        struct range
+        {
+            const edge<W>* first;
+            const edge<W>* last;
+
+            const edge<W>* begin() const { return first; }
+            const edge<W>* end() const   { return last; }
+            int size() const             { return last - first; }
+            bool empty() const           { return first == last; }
+        };
+
+        csr_graph() : offsets_(1, 0) {}
+
+        int nbr_nodes() const { return offsets_.size() - 1; }
+        int nbr_edges() const { return edges_.size(); }
+
+        range neighbors(int u) const
+        {
+            return { edges_.data() + offsets_[u], edges_.data() + offsets_[u + 1] };
+        }
+
+        int out_degree(int u) const
+        {
+            return offsets_[u + 1] - offsets_[u];
+        }
+
+        // Same graph, edges reversed
+        csr_graph reversed() const;
+    };
+
+    template <typename W = int>
+    class csr_builder
+    {
+        struct fullEdge
+        {
+            int from;
+            int to;
+            W weight;
+        };
+
+        std::vector<fullEdge> edges_;
+
+    public:
+
+        void add_edge(int from, int to, W weight = W())
+        {
+            edges_.push_back({from, to, weight});
+        }
+
+        // Both directions
+        void add_undirected_edge(int u, int v, W weight = W())
+        {
+            add_edge(u, v, weight);
+            add_edge(v, u, weight);
+        }
+
+        // Counting sort on the source node, the insertion order is kept
+        csr_graph<W> build(int nbrNodes) const
+        {
+            csr_graph<W> g;
+
+            g.offsets_.assign(nbrNodes + 1, 0);
+            for(auto& e : edges_)
+                g.offsets_[e.from + 1]++;
+
+            for(int u=0; u<nbrNodes; u++)
+                g.offsets_[u + 1] += g.offsets_[u];
+
+            std::vector<int> next(g.offsets_.begin(), g.offsets_.end() - 1);
+            g.edges_.resize(edges_.size());
+
+            for(auto& e : edges_)
+                g.edges_[next[e.from]++] = {e.to, e.weight};
+
+            return g;
+        }
+    };
+
+    template <typename W>
+    csr_graph<W> csr_graph<W>::reversed() const
+    {
+        csr_builder<W> builder;
+
+        for(int u=0; u<nbr_nodes(); u++)
+            for(auto& e : neighbors(u))
+                builder.add_edge(e.to, u, e.weight);
+
+        return builder.build(nbr_nodes());
+    }
+
+    // Number of edges from source to every node, -1 if unreachable
+    template <typename W>
+    std::vector<int> bfs_distances(const csr_graph<W>& g, int source)
+    {
+        std::vector<int> dist(g.nbr_nodes(), -1);
+        std::vector<int> queue;
+        queue.reserve(g.nbr_nodes());
+
+        dist[source] = 0;
+        queue.push_back(source);
+
+        for(std::size_t head=0; head<queue.size(); head++)
+        {
+            int u = queue[head];
+
+            for(auto& e : g.neighbors(u))
+            {
+                if(dist[e.to] < 0)
+                {
+                    dist[e.to] = dist[u] + 1;
+                    queue.push_back(e.to);
+                }
+            }
+        }
+
+        return dist;
+    }
+
+    // Iterative depth-first traversal from source, visit(u) called once per
+    // reachable node, in preorder.
+    template <typename W, typename Visit>
+    void dfs(const csr_graph<W>& g, int source, Visit visit)
+    {
+        std::vector<bool> seen(g.nbr_nodes(), false);
+        std::vector<int> stack;
+
+        stack.push_back(source);
+
+        while(!stack.empty())
+        {
+            int u = stack.back();
+            stack.pop_back();
+
+            if(seen[u])
+                continue;
+
+            seen[u] = true;
+            visit(u);
+
+            // Reverse order: the first neighbor is visited first
+            auto n = g.neighbors(u);
+            for(auto e = n.end(); e != n.begin(); )
+            {
+                --e;
+                if(!seen[e->to])
+                    stack.push_back(e->to);
+            }
+        }
+    }
+
+    // Kahn's algorithm. Every edge u->v has u before v.
+    // If the graph has a cycle, the result holds less than nbr_nodes() nodes.
+    template <typename W>
+    std::vector<int> topological_sort(const csr_graph<W>& g)
+    {
+        std::vector<int> inDegree(g.nbr_nodes(), 0);
+
+        for(int u=0; u<g.nbr_nodes(); u++)
+            for(auto& e : g.neighbors(u))
+                inDegree[e.to]++;
+
+        std::vector<int> order;
+        order.reserve(g.nbr_nodes());
+
+        for(int u=0; u<g.nbr_nodes(); u++)
+            if(inDegree[u] == 0)
+                order.push_back(u);
+
+        for(std::size_t head=0; head<order.size(); head++)
+        {
+            for(auto& e : g.neighbors(order[head]))
+            {
+                if(--inDegree[e.to] == 0)
+                    order.push_back(e.to);
+            }
+        }
+
+        return order;
+    }
+
+    // Memoized fold over a DAG, from the sinks up:
+    //   value[u] = f(u, value)
+    // where f may read value[v] for every successor v of u, these are already
+    // computed. Each node is evaluated exactly once.
+    template <typename T, typename W, typename F>
+    std::vector<T> dag_fold(const csr_graph<W>& g, F f)
+    {
+        std::vector<int> order = topological_sort(g);
+        std::vector<T> value(g.nbr_nodes(), T());
+
+        for(auto it = order.rbegin(); it != order.rend(); ++it)
+            value[*it] = f(*it, value);
+
+        return value;
+    }
+}
+}
+
+#endif  // MYGRAPH_H
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <list>
 #include <vector>
 #include <deque>
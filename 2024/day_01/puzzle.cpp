@@ -12,11 +12,27 @@
 #include <regex>
 #include "myutils.h"
 
+#ifdef AOC_EMBEDDED_INPUT
+#include "aoc_input.h"
+#endif
+
 using namespace std;
 
+// Read the left and right lists
+template <typename T>
+constexpr void read_lists(const T& data, std::vector<long>& leftList, std::vector<long>& rightList)
+{
+    for(const auto& s: data)
+    {
+        auto values = myutils::parse_ints<long>(s);
+        leftList.push_back(values[0]);
+        rightList.push_back(values[1]);
+    }
+}
+
 // Solve puzzle #1
 template <typename T>
-long solve_puzzle1(T data)
+constexpr long solve_puzzle1(const T& data)
 {
 #if 0
     for(auto s : data)
@@ -28,14 +44,7 @@ long solve_puzzle1(T data)
     std::vector<long> leftList;
     std::vector<long> rightList;
 
-    for(auto s: data)
-    {
-        std::istringstream is( s );
-        long n1, n2;
-        is >> n1 >> n2;
-        leftList.push_back(n1);
-        rightList.push_back(n2);
-    }
+    read_lists(data, leftList, rightList);
 
     // Sort both arrays
     std::sort (leftList.begin(), leftList.end());
@@ -45,7 +54,7 @@ long solve_puzzle1(T data)
     long totDistance=0;
     for(int i=0; i<leftList.size(); i++)
     {
-        totDistance += abs(leftList[i] - rightList[i]);
+        totDistance += myutils::abs(leftList[i] - rightList[i]);
     }
 
     // Return sum
@@ -54,7 +63,7 @@ long solve_puzzle1(T data)
 
 // Solve puzzle #2
 template <typename T>
-long solve_puzzle2(T data)
+constexpr long solve_puzzle2(const T& data)
 {
 #if 0
     for(auto s : data)
@@ -65,15 +74,8 @@ long solve_puzzle2(T data)
 
     std::vector<long> leftList;
     std::vector<long> rightList;
-    std::vector<long> mult;
-    for(auto s: data)
-    {
-        std::istringstream is( s );
-        long n1, n2;
-        is >> n1 >> n2;
-        leftList.push_back(n1);
-        rightList.push_back(n2);
-    }
+
+    read_lists(data, leftList, rightList);
 
     // Compute similarity score
     long long simScore=0L;
@@ -88,8 +90,20 @@ long solve_puzzle2(T data)
     return simScore;
 }
 
+// The examples are verified during compilation
+constexpr std::string_view example = R"(3 4
+4 3
+2 5
+1 3
+3 9
+3 3)";
+
+static_assert(solve_puzzle1(myutils::split_lines(example)) == 11 && "Error verifying puzzle #1");
+static_assert(solve_puzzle2(myutils::split_lines(example)) == 31 && "Error verifying puzzle #2");
+
 int main(int argc, char *argv[])
 {
+#ifndef AOC_EMBEDDED_INPUT
     // Need a command-line parameter for the input filename
     if (argc != 2) {
         cerr << "Error: missing input" << endl;
@@ -112,27 +126,23 @@ int main(int argc, char *argv[])
     bool debug = false;
 
     myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
-
-    const vector<string> example = {
-        "3 4",
-        "4 3",
-        "2 5",
-        "1 3",
-        "3 9",
-        "3 3"  };
+#endif
 
     // --------- Puzzle #1 ---------
-    // Verify puzzle1 examples
-    assert(solve_puzzle1<vector<string>>(example) == 11 && "Error verifying puzzle #1");
-
-    // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;  // 54644
+#ifdef AOC_EMBEDDED_INPUT
+    // Solved during compilation
+    constexpr long answer1 = solve_puzzle1(myutils::split_lines(aoc_input));
+#else
+    long answer1 = solve_puzzle1(data);
+#endif
+    std::cout << "Answer for puzzle #1: "<< answer1 << std::endl;  // 54644
 
     // --------- Puzzle #2 ---------
-    // Verify puzzle2 examples
-    assert(solve_puzzle2<vector<string>>(example) == 31 && "Error verifying puzzle #2");
-
-    // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;  // 53348
+#ifdef AOC_EMBEDDED_INPUT
+    constexpr long answer2 = solve_puzzle2(myutils::split_lines(aoc_input));
+#else
+    long answer2 = solve_puzzle2(data);
+#endif
+    std::cout << "Answer for puzzle #2: "<< answer2 << std::endl;  // 53348
 
 }
@@ -12,9 +12,13 @@
 #include <regex>
 #include "myutils.h"
 
+#ifdef AOC_EMBEDDED_INPUT
+#include "aoc_input.h"
+#endif
+
 using namespace std;
 
-bool isReportSafe(vector<int> reportLevels, bool debug)
+constexpr bool isReportSafe(const vector<int>& reportLevels, bool debug)
 {
 
     bool isIncreasing = false;
@@ -47,7 +51,7 @@ bool isReportSafe(vector<int> reportLevels, bool debug)
 
         while(ptrNext != reportLevels.end())
         {
-            int delta = abs(*ptr - *ptrNext);
+            int delta = myutils::abs(*ptr - *ptrNext);
             if(delta > 0 && delta <= 3)
             {
                 isSafe = true;
@@ -73,7 +77,7 @@ bool isReportSafe(vector<int> reportLevels, bool debug)
 
 // Solve puzzle #1
 template <typename T>
-long solve_puzzle1(T data, bool debug=false)
+constexpr long solve_puzzle1(const T& data, bool debug=false)
 {
     if(debug)
     {
@@ -86,17 +90,7 @@ long solve_puzzle1(T data, bool debug=false)
 
     for(auto report: data)
     {
-        std::istringstream is( report );
-
-        string str;
-
-        std::vector<int> levels;
-
-        while (getline(is, str, ' ') )
-        {
-            int level = stoi(str);
-            levels.push_back(level);
-        }
+        std::vector<int> levels = myutils::parse_ints<int>(report);
 
         if(debug)
         {
@@ -114,7 +108,7 @@ long solve_puzzle1(T data, bool debug=false)
 
 // Solve puzzle #2
 template <typename T>
-long solve_puzzle2(T data, bool debug = false)
+constexpr long solve_puzzle2(const T& data, bool debug = false)
 {
     if(debug)
     {
@@ -127,17 +121,7 @@ long solve_puzzle2(T data, bool debug = false)
 
     for(auto report: data)
     {
-        std::istringstream is( report );
-
-        string str;
-
-        std::vector<int> levels;
-
-        while (getline(is, str, ' ') )
-        {
-            int level = stoi(str);
-            levels.push_back(level);
-        }
+        std::vector<int> levels = myutils::parse_ints<int>(report);
 
         if(debug)
         {
@@ -182,8 +166,20 @@ long solve_puzzle2(T data, bool debug = false)
     return nbrSafeReports;
 }
 
+// The examples are verified during compilation
+constexpr std::string_view example = R"(7 6 4 2 1
+1 2 7 8 9
+9 7 6 2 1
+1 3 2 4 5
+8 6 4 4 1
+1 3 6 7 9)";
+
+static_assert(solve_puzzle1(myutils::split_lines(example)) == 2 && "Error verifying puzzle #1");
+static_assert(solve_puzzle2(myutils::split_lines(example)) == 4 && "Error verifying puzzle #2");
+
 int main(int argc, char *argv[])
 {
+#ifndef AOC_EMBEDDED_INPUT
     // Need a command-line parameter for the input filename
     if (argc != 2) {
         cerr << "Error: missing input" << endl;
@@ -206,28 +202,23 @@ int main(int argc, char *argv[])
     bool debug = false;
 
     myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
-
-    const vector<string> example = {
-        "7 6 4 2 1",
-        "1 2 7 8 9",
-        "9 7 6 2 1",
-        "1 3 2 4 5",
-        "8 6 4 4 1",
-        "1 3 6 7 9"
-    };
+#endif
 
     // --------- Puzzle #1 ---------
-    // Verify puzzle1 examples
-    assert(solve_puzzle1<vector<string>>(example, false) == 2 && "Error verifying puzzle #1");
-
-    // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;  // 54644
+#ifdef AOC_EMBEDDED_INPUT
+    // Solved during compilation
+    constexpr long answer1 = solve_puzzle1(myutils::split_lines(aoc_input));
+#else
+    long answer1 = solve_puzzle1(data);
+#endif
+    std::cout << "Answer for puzzle #1: "<< answer1 << std::endl;
 
     // --------- Puzzle #2 ---------
-    // Verify puzzle2 examples
-    assert(solve_puzzle2<vector<string>>(example, false) == 4 && "Error verifying puzzle #2");
-
-    // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;  // 53348
+#ifdef AOC_EMBEDDED_INPUT
+    constexpr long answer2 = solve_puzzle2(myutils::split_lines(aoc_input));
+#else
+    long answer2 = solve_puzzle2(data);
+#endif
+    std::cout << "Answer for puzzle #2: "<< answer2 << std::endl;
 
 }
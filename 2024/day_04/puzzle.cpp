@@ -12,236 +12,127 @@
 #include <regex>
 #include "myutils.h"
 
-using namespace std;
+#ifdef AOC_EMBEDDED_INPUT
+#include "aoc_input.h"
+#endif
 
+using namespace std;
 
-struct Coord
-{
-    int x;
-    int y;
+// The 8 reading directions of a word in the grid
+//
+//        --------->    X axis
+//        |
+//        |
+//        V  Y axis
+//
+// Letter k of a word starting at (x, y) is at (x + k*dx, y + k*dy).
+constexpr myutils::point directions[8] = {
+    { 1,  0}, {-1,  0}, { 0, -1}, { 0,  1},  // horizontal, vertical
+    { 1, -1}, {-1,  1}, {-1, -1}, { 1,  1}   // diagonals
 };
 
-
+// Number of times word reads from (x, y), in any direction
 template <typename T>
-class patternMatch
+constexpr int count_words(const myutils::grid_view<T>& grid, int x, int y, std::string_view word)
 {
-    // Generate all possible matrix patterns for a ref pattern of a given size
-    //
-    // Here for a 4-letter pattern like XMAS
-    //
-    //        --------->    X axis
-    //        |
-    //        |
-    //        |
-    //        |
-    //        V  Y axis
-    //
-    //         pattern 0:  ....  ->      stepX: [0, 1, 2, 3]
-    //                                   stepY: [0, 0, 0, 0]
-    //
-    //         pattern 1:  ....  <-      stepX: [0, -1, -2, -3]
-    //                                   stepY: [0,  0,  0,  0]
-    //                     .
-    //                     .
-    //                     .   ^
-    //         pattern 2:  .   |         stepX: [0,  0,  0,  0]
-    //                                   stepY: [0, -1, -2, -3]
-    //                     .
-    //                     .
-    //                     .   |
-    //         pattern 3:  .   V         stepX: [0, 0, 0, 0]
-    //                                   stepY: [0, 1, 2, 3]
-    //
-    //                        .
-    //                       .
-    //                      .  ^
-    //         pattern 4:  .   /         stepX: [0,  1,  2,  3]
-    //                                   stepY: [0, -1, -2, -3]
-    //
-    //                        .
-    //                       .
-    //                      .  /
-    //         pattern 5:  .   V         stepX: [0, -1, -2, -3]
-    //                                   stepY: [0,  1,  2,  3]
-    //
-    //                     .
-    //                      .
-    //                       .  ^
-    //         pattern 6:     .  \       stepX: [0, -1, -2, -3]
-    //                                   stepY: [0, -1, -2, -3]
-    //
-    //                     .
-    //                      .
-    //                       .  \
-    //         pattern 7:     .  V       stepX: [0, 1, 2, 3]
-    //                                   stepY: [0, 1, 2, 3]
-
-private:
-    int    _maxX;
-    int    _maxY;
-    string _pattern;
-
-public:
-
-    const struct Coord steps[8][4] = {
-        {{ 0,  0}, { 1,  0}, { 2,  0}, { 3,  0}},  // pattern 0
-        {{ 0,  0}, {-1,  0}, {-2,  0}, {-3,  0}},  // pattern 1
-        {{ 0,  0}, { 0, -1}, { 0, -2}, { 0, -3}},  // pattern 2
-        {{ 0,  0}, { 0,  1}, { 0,  2}, { 0,  3}},  // pattern 3
-        {{ 0,  0}, { 1, -1}, { 2, -2}, { 3, -3}},  // pattern 4
-        {{ 0,  0}, {-1,  1}, {-2,  2}, {-3,  3}},  // pattern 5
-        {{ 0,  0}, {-1, -1}, {-2, -2}, {-3, -3}},  // pattern 6
-        {{ 0,  0}, { 1,  1}, { 2,  2}, { 3,  3}}   // pattern 7
-    }
-    ;
-
-    // Constructor
-    patternMatch ()
-        :
-        _maxX(-1),
-        _maxY(-1),
-        _pattern("")
-    {};
+    int nbrMatch = 0;
 
-    patternMatch(int maxX, int maxY, string pattern)
-        :
-        _maxX(maxX),
-        _maxY(maxY),
-        _pattern(pattern)
+    for(const auto& d : directions)
     {
-    }
+        int k = 0;
 
-    // Copy constructor
-    patternMatch(const patternMatch &pm)
-    {
-        this->_maxX = pm._maxX;
-        this->_maxY = pm._maxY;
-        this->_pattern = pm._pattern;
-    }
+        // Out of bounds reads as '.', which ends the match
+        while(k < (int)word.size() && grid.at(x + k*d.x, y + k*d.y, '.') == word[k])
+            k++;
 
-    bool checkInBound(const struct Coord& c)
-    {
-        return
-            (c.x >= 0) && (c.x < _maxX) &&
-            (c.y >= 0) && (c.y < _maxY);
+        if(k == (int)word.size())
+            nbrMatch++;
     }
 
-    int findMatch(int x, int y, T& data, bool debug=false)
-    {
-        int nbrMatch = 0;
-
-        for (auto s : steps)
-        {
-            struct Coord letterCoords[4] = {
-                {x + s[0].x, y + s[0].y},
-                {x + s[1].x, y + s[1].y},
-                {x + s[2].x, y + s[2].y},
-                {x + s[3].x, y + s[3].y}
-            };
-
-            if (
-                checkInBound(letterCoords[0]) &&
-                checkInBound(letterCoords[1]) &&
-                checkInBound(letterCoords[2]) &&
-                checkInBound(letterCoords[3])
-            )
-            {
-                char word[5] = {
-                    data[letterCoords[0].y][letterCoords[0].x],
-                    data[letterCoords[1].y][letterCoords[1].x],
-                    data[letterCoords[2].y][letterCoords[2].x],
-                    data[letterCoords[3].y][letterCoords[3].x],
-                    '\0'
-                };
-
-                if(debug)
-                    cout << "word: " << word << endl;
-
-                if(std::strncmp(word, "XMAS", 4) == 0)
-                {
-                    nbrMatch++;
-                }
-
-            }
-        }
-
-        return nbrMatch;
-    }
-
-    friend ostream& operator<<(ostream& os, const patternMatch& line);
-
-};
-
+    return nbrMatch;
+}
 
 // Solve puzzle #1
 template <typename T>
-long long solve_puzzle1(T data, bool debug=false)
+constexpr long long solve_puzzle1(const T& data)
 {
-    if(debug)
-    {
-        for(auto s : data)
-            cout<< s <<"\n";
-    }
-
-    int maxX = data[0].size();
-    int maxY = data.size();
-
-    int nbrMatch = 0;
+    myutils::grid_view<T> grid(data);
 
-    // Create the pattern matcher
-    patternMatch<T> pm(maxX, maxY, "XMAS");
+    long long nbrMatch = 0;
 
-    for(int j=0; j<maxY; j++)
+    for(int y=0; y<grid.height(); y++)
     {
-        for(int i=0; i<maxX; i++)
+        for(int x=0; x<grid.width(); x++)
         {
-            nbrMatch += pm.findMatch(i, j, data, debug);
+            if(grid.at(x, y) == 'X')
+                nbrMatch += count_words(grid, x, y, "XMAS");
         }
     }
 
     return nbrMatch;
 }
 
+// Both diagonals through (x, y) read MAS, forward or backward
+template <typename T>
+constexpr bool is_x_mas(const myutils::grid_view<T>& grid, int x, int y)
+{
+    auto isMS = [](char a, char b) { return (a == 'M' && b == 'S') || (a == 'S' && b == 'M'); };
+
+    return
+        grid.at(x, y) == 'A' &&
+        isMS(grid.at(x+1, y-1, '.'), grid.at(x-1, y+1, '.')) &&  // upper right, lower left
+        isMS(grid.at(x-1, y-1, '.'), grid.at(x+1, y+1, '.'));    // upper left, lower right
+}
 
 // Solve puzzle #2
 template <typename T>
-long solve_puzzle2(T data, bool debug = false)
+constexpr long solve_puzzle2(const T& data)
 {
-    int maxX = data[0].size();
-    int maxY = data.size();
+    myutils::grid_view<T> grid(data);
 
-    int nbrMatch = 0;
+    long nbrMatch = 0;
 
-    // Locate the A's. Check diagonal neighbours, quick and dirty
-    for(int y=1; y<maxY-1; y++)      // Skip the upper and lower borders
+    for(int y=0; y<grid.height(); y++)
     {
-        for(int x=1; x<maxX-1; x++)  // Skip the left and right sides
+        for(int x=0; x<grid.width(); x++)
         {
-            if(data[y][x] == 'A')
-            {
-                char ur = data[y-1][x+1];  // upper right character
-                char ul = data[y-1][x-1];  // upper left character
-                char lr = data[y+1][x+1];  // lower right character
-                char ll = data[y+1][x-1];  // lower left character
-
-                if(
-                    ((ur == 'M' && ll == 'S') || (ur == 'S' && ll == 'M')) &&
-                    ((ul == 'M' && lr == 'S') || (ul == 'S' && lr == 'M'))
-                )
-                {
-                    nbrMatch++;
-                }
-            }
+            if(is_x_mas(grid, x, y))
+                nbrMatch++;
         }
     }
 
     return nbrMatch;
-
-    return 0;
 }
 
+// The examples are verified during compilation
+constexpr std::string_view example1 = R"(MMMSXXMASM
+MSAMXMSMSA
+AMXSXMAAMM
+MSAMASMSMX
+XMASAMXAMM
+XXAMMXXAMA
+SMSMSASXSS
+SAXAMASAAA
+MAMMMXMMMM
+MXMXAXMASX)";
+
+constexpr std::string_view example2 = R"(.M.S......
+..A..MSMS.
+.M.S.MAA..
+..A.ASMSM.
+.M.S.M....
+..........
+S.S.S.S.S.
+.A.A.A.A..
+M.M.M.M.M.
+..........)";
+
+static_assert(solve_puzzle1(myutils::split_lines(example1)) == 18 && "Error verifying puzzle #1");
+static_assert(solve_puzzle2(myutils::split_lines(example2)) == 9 && "Error verifying puzzle #2");
+
 int main(int argc, char *argv[])
 {
+#ifndef AOC_EMBEDDED_INPUT
     // Need a command-line parameter for the input filename
     if (argc != 2) {
         cerr << "Error: missing input" << endl;
@@ -264,44 +155,22 @@ int main(int argc, char *argv[])
     bool debug = false;
 
     myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
-
-    const std::vector<string> example1 = {
-        "MMMSXXMASM",
-        "MSAMXMSMSA",
-        "AMXSXMAAMM",
-        "MSAMASMSMX",
-        "XMASAMXAMM",
-        "XXAMMXXAMA",
-        "SMSMSASXSS",
-        "SAXAMASAAA",
-        "MAMMMXMMMM",
-        "MXMXAXMASX"
-    };
-
-    const std::vector<string> example2 = {
-        ".M.S......",
-        "..A..MSMS.",
-        ".M.S.MAA..",
-        "..A.ASMSM.",
-        ".M.S.M....",
-        "..........",
-        "S.S.S.S.S.",
-        ".A.A.A.A..",
-        "M.M.M.M.M.",
-        ".........."
-    };
+#endif
 
     // --------- Puzzle #1 ---------
-    // Verify puzzle1 examples
-    assert(solve_puzzle1<vector<string>>(example1) == 18 && "Error verifying puzzle #1");
-
-    // Solve puzzle #1
-    std::cout << "Answer for puzzle #1: "<< solve_puzzle1(data) << std::endl;  // 2370
+#ifdef AOC_EMBEDDED_INPUT
+    // Solved during compilation
+    constexpr long long answer1 = solve_puzzle1(myutils::split_lines(aoc_input));
+#else
+    long long answer1 = solve_puzzle1(data);
+#endif
+    std::cout << "Answer for puzzle #1: "<< answer1 << std::endl;  // 2370
 
     // --------- Puzzle #2 ---------
-    // Verify puzzle2 examples
-    assert(solve_puzzle2<vector<string>>(example2) == 9 && "Error verifying puzzle #2");
-
-    // Solve puzzle #2
-    std::cout << "Answer for puzzle #2: "<< solve_puzzle2(data) << std::endl;  // 1908
+#ifdef AOC_EMBEDDED_INPUT
+    constexpr long answer2 = solve_puzzle2(myutils::split_lines(aoc_input));
+#else
+    long answer2 = solve_puzzle2(data);
+#endif
+    std::cout << "Answer for puzzle #2: "<< answer2 << std::endl;  // 1908
 }
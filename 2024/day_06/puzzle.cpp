@@ -11,6 +11,7 @@
 #include <numeric>
 #include <algorithm>
 #include "myutils.h"
+#include "myinstrument.h"
 
 using namespace std;
 
@@ -188,21 +189,27 @@ struct navMap {
     // Navigate the map. At the end, report the number of distinct positions
     int navigate(bool& loopDetected)
     {
+        AOC_TIMER("navigate");
+
         int nbrPosVisited = 0;
 
         loopDetected = false;
 
         while(! outOfBound())
         {
+            AOC_COUNT("navigate.steps");
+
             // Bumping into something?
             while( detectObstacle() )
             {
+                AOC_COUNT("navigate.turns");
                 changeDirection();
             }
 
             // Detect loops
             if (isLooping ())
             {
+                AOC_COUNT("navigate.loops");
                 loopDetected = true;
 
                 break;
@@ -278,6 +285,8 @@ struct navMap {
 template <typename T>
 long long solve_puzzle1(T data, bool debug=false)
 {
+    AOC_TIMER("solve_puzzle1");
+
     if(debug)
     {
         for(auto s : data)
@@ -298,6 +307,8 @@ long long solve_puzzle1(T data, bool debug=false)
 template <typename T>
 long solve_puzzle2(T data, bool debug = false)
 {
+    AOC_TIMER("solve_puzzle2");
+
     if(debug)
     {
         for(auto s : data)
@@ -314,6 +325,8 @@ long solve_puzzle2(T data, bool debug = false)
     {
         for(int x=0; x< origMap._max_x; x++)
         {
+            AOC_COUNT("solve_puzzle2.obstacle");
+
             // Start from a fresh new map
             struct navMap<T> theMap(data, debug);
 
@@ -365,7 +378,10 @@ int main(int argc, char *argv[])
     bool keepEmptyLine = false;
     bool debug = false;
 
-    myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
+    {
+        AOC_TIMER("parse");
+        myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
+    }
 
     const std::vector<string> example = {
         "....#.....",
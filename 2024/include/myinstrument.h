@@ -0,0 +1,331 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// Hot path instrumentation: scoped timers, named counters, histograms and
+// trace events.
+//
+// Everything is compiled out unless AOC_INSTRUMENT is defined (cmake
+// -DAOC_INSTRUMENT=ON). The macro arguments are then not even evaluated, so
+// the instrumentation can stay in the inner loops.
+//
+//   AOC_TIMER("solve");                // scoped timer + trace event
+//   AOC_COUNT("navigate.steps");       // counter += 1
+//   AOC_COUNT_ADD("fish.kids", n);     // counter += n
+//   AOC_HISTOGRAM("depth", depth);     // log2 histogram of the values
+//   AOC_TRACE_INSTANT("loop found");   // instant trace event
+//
+// The names must be string literals. At exit, a summary is printed on
+// stderr, and the trace events are written in Chrome trace-event JSON to the
+// file named by the AOC_TRACE environment variable, if set (open it with
+// chrome://tracing or https://ui.perfetto.dev).
+
+#ifndef MYINSTRUMENT_H
+#define MYINSTRUMENT_H
+
+#ifdef AOC_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace myutils
+{
+namespace instrument
+{
+    typedef std::chrono::steady_clock clock;
+
+    // Trace events kept per thread, past that only the statistics are kept
+    static const std::size_t MAX_TRACE_EVENTS_PER_THREAD = 1000000;
+
+    struct counter
+    {
+        const char* name;
+        std::atomic<std::uint64_t> value{0};
+
+        explicit counter(const char* n) : name(n) {}
+    };
+
+    struct timer_stats
+    {
+        const char* name;
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> totalNs{0};
+
+        explicit timer_stats(const char* n) : name(n) {}
+    };
+
+    // Histogram with power of 2 buckets: bucket i holds [2^(i-1), 2^i)
+    struct histogram
+    {
+        static const int NBR_BUCKETS = 65;
+
+        const char* name;
+        std::atomic<std::uint64_t> buckets[NBR_BUCKETS] = {};
+        std::atomic<std::uint64_t> samples{0};
+        std::atomic<std::int64_t>  sum{0};
+
+        explicit histogram(const char* n) : name(n) {}
+
+        void add(std::int64_t value)
+        {
+            std::uint64_t v = value < 0 ? 0 : static_cast<std::uint64_t>(value);
+            int bucket = v == 0 ? 0 : 64 - __builtin_clzll(v);
+
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            samples.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(value, std::memory_order_relaxed);
+        }
+    };
+
+    struct trace_event
+    {
+        const char* name;
+        char phase;             // 'X': complete, 'i': instant
+        std::int64_t tsNs;
+        std::int64_t durNs;
+    };
+
+    struct thread_buffer
+    {
+        int tid;
+        std::vector<trace_event> events;
+    };
+
+    class registry
+    {
+        std::mutex mutex_;
+
+        // std::list: stable addresses, the macros keep references
+        std::list<counter>      counters_;
+        std::list<timer_stats>  timers_;
+        std::list<histogram>    histograms_;
+        std::list<std::unique_ptr<thread_buffer>> threads_;
+
+        clock::time_point start_;
+
+        template <typename T>
+        T& find_or_add(std::list<T>& items, const char* name)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for(auto& item : items)
+            {
+                if(std::string(item.name) == name)
+                    return item;
+            }
+            return items.emplace_back(name);
+        }
+
+        void report(std::ostream& os)
+        {
+            os << "---- Instrumentation ----" << std::endl;
+
+            for(auto& t : timers_)
+            {
+                double ms = t.totalNs.load() / 1e6;
+                os << "timer     " << std::setw(32) << std::left << t.name << std::right
+                    << std::setw(12) << t.calls.load() << " calls "
+                    << std::setw(12) << std::fixed << std::setprecision(3) << ms << " ms"
+                    << std::endl;
+            }
+
+            for(auto& c : counters_)
+            {
+                os << "counter   " << std::setw(32) << std::left << c.name << std::right
+                    << std::setw(12) << c.value.load() << std::endl;
+            }
+
+            for(auto& h : histograms_)
+            {
+                std::uint64_t n = h.samples.load();
+                os << "histogram " << std::setw(32) << std::left << h.name << std::right
+                    << std::setw(12) << n << " samples, mean: "
+                    << (n ? double(h.sum.load()) / n : 0.0) << std::endl;
+
+                for(int i=0; i<histogram::NBR_BUCKETS; i++)
+                {
+                    std::uint64_t b = h.buckets[i].load();
+                    if(b == 0)
+                        continue;
+
+                    std::uint64_t low = i == 0 ? 0 : (std::uint64_t(1) << (i - 1));
+                    os << "          " << std::setw(22) << ("[" + std::to_string(low) + ", ")
+                        << (i == 0 ? std::string("1") : (i == 64 ? std::string("inf") : std::to_string(std::uint64_t(1) << i)))
+                        << ") " << b << std::endl;
+                }
+            }
+        }
+
+        void write_trace(const char* filename)
+        {
+            std::ofstream os(filename);
+
+            os << "{\"traceEvents\":[";
+
+            bool first = true;
+            for(auto& t : threads_)
+            {
+                for(auto& e : t->events)
+                {
+                    os << (first ? "\n" : ",\n")
+                        << "{\"name\":\"" << e.name << "\",\"ph\":\"" << e.phase
+                        << "\",\"pid\":1,\"tid\":" << t->tid
+                        << ",\"ts\":" << std::fixed << std::setprecision(3) << e.tsNs / 1e3;
+
+                    if(e.phase == 'X')
+                        os << ",\"dur\":" << e.durNs / 1e3;
+                    else
+                        os << ",\"s\":\"t\"";
+
+                    os << "}";
+                    first = false;
+                }
+            }
+
+            // Final counter values, as counter events
+            for(auto& c : counters_)
+            {
+                os << (first ? "\n" : ",\n")
+                    << "{\"name\":\"" << c.name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":"
+                    << since_start_ns() / 1e3
+                    << ",\"args\":{\"value\":" << c.value.load() << "}}";
+                first = false;
+            }
+
+            os << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+        }
+
+    public:
+
+        registry() : start_(clock::now()) {}
+
+        ~registry()
+        {
+            report(std::cerr);
+
+            if(const char* filename = std::getenv("AOC_TRACE"))
+                write_trace(filename);
+        }
+
+        static registry& instance()
+        {
+            static registry theRegistry;
+            return theRegistry;
+        }
+
+        std::int64_t since_start_ns() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+        }
+
+        counter& get_counter(const char* name)       { return find_or_add(counters_, name); }
+        timer_stats& get_timer(const char* name)     { return find_or_add(timers_, name); }
+        histogram& get_histogram(const char* name)   { return find_or_add(histograms_, name); }
+
+        // The calling thread's trace buffer
+        thread_buffer& get_thread_buffer()
+        {
+            thread_local thread_buffer* buffer = nullptr;
+
+            if(buffer == nullptr)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                threads_.push_back(std::make_unique<thread_buffer>());
+                buffer = threads_.back().get();
+                buffer->tid = threads_.size();
+            }
+            return *buffer;
+        }
+
+        void add_event(const trace_event& e)
+        {
+            thread_buffer& b = get_thread_buffer();
+
+            if(b.events.size() < MAX_TRACE_EVENTS_PER_THREAD)
+                b.events.push_back(e);
+        }
+    };
+
+    // RAII timer: accumulates in the stats, and records a complete event
+    class scoped_timer
+    {
+        timer_stats& stats_;
+        std::int64_t startNs_;
+
+    public:
+        explicit scoped_timer(timer_stats& stats)
+            : stats_(stats),
+              startNs_(registry::instance().since_start_ns())
+        {}
+
+        ~scoped_timer()
+        {
+            registry& r = registry::instance();
+            std::int64_t durNs = r.since_start_ns() - startNs_;
+
+            stats_.calls.fetch_add(1, std::memory_order_relaxed);
+            stats_.totalNs.fetch_add(durNs, std::memory_order_relaxed);
+
+            r.add_event({stats_.name, 'X', startNs_, durNs});
+        }
+    };
+}
+}
+
+#define AOC_INSTRUMENT_CAT2(a, b) a##b
+#define AOC_INSTRUMENT_CAT(a, b) AOC_INSTRUMENT_CAT2(a, b)
+#define AOC_INSTRUMENT_VAR(prefix) AOC_INSTRUMENT_CAT(prefix, __LINE__)
+
+// The lookup by name is done only once per call site
+#define AOC_TIMER(name)                                                         \
+    static myutils::instrument::timer_stats& AOC_INSTRUMENT_VAR(aocTimerStats_) \
+        = myutils::instrument::registry::instance().get_timer(name);           \
+    myutils::instrument::scoped_timer AOC_INSTRUMENT_VAR(aocTimer_)(AOC_INSTRUMENT_VAR(aocTimerStats_))
+
+#define AOC_COUNT_ADD(name, n)                                                  \
+    do {                                                                        \
+        static myutils::instrument::counter& aocCounter_                        \
+            = myutils::instrument::registry::instance().get_counter(name);      \
+        aocCounter_.value.fetch_add((n), std::memory_order_relaxed);            \
+    } while(0)
+
+#define AOC_COUNT(name) AOC_COUNT_ADD(name, 1)
+
+#define AOC_HISTOGRAM(name, value)                                              \
+    do {                                                                        \
+        static myutils::instrument::histogram& aocHistogram_                    \
+            = myutils::instrument::registry::instance().get_histogram(name);    \
+        aocHistogram_.add(value);                                               \
+    } while(0)
+
+#define AOC_TRACE_INSTANT(name)                                                 \
+    do {                                                                        \
+        myutils::instrument::registry& aocRegistry_                             \
+            = myutils::instrument::registry::instance();                        \
+        aocRegistry_.add_event({name, 'i', aocRegistry_.since_start_ns(), 0});  \
+    } while(0)
+
+#else
+
+#define AOC_TIMER(name)                 do {} while(0)
+#define AOC_COUNT_ADD(name, n)          do {} while(0)
+#define AOC_COUNT(name)                 do {} while(0)
+#define AOC_HISTOGRAM(name, value)      do {} while(0)
+#define AOC_TRACE_INSTANT(name)         do {} while(0)
+
+#endif  // AOC_INSTRUMENT
+
+#endif  // MYINSTRUMENT_H
@@ -13,6 +13,7 @@
 #include <iterator>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -93,19 +94,19 @@ template <typename T_container = std::vector<int>>
         int x;
         int y;
 
-        point() : x(0), y(0) {}
-        point(int valx, int valy) : x(valx), y(valy) {}
-        point(const point& p) : x(p.x), y(p.y) {}
-        point (point&& p): x(std::move(p.x)), y(std::move(p.y)) {}
+        constexpr point() : x(0), y(0) {}
+        constexpr point(int valx, int valy) : x(valx), y(valy) {}
+        constexpr point(const point& p) : x(p.x), y(p.y) {}
+        constexpr point (point&& p): x(std::move(p.x)), y(std::move(p.y)) {}
 
-        point& operator=(point other)
+        constexpr point& operator=(point other)
         {
             x = other.x;
             y = other.y;
             return *this;
         }
 
-        point operator+(point other)
+        constexpr point operator+(point other)
         {
             other.x += x;
             other.y += y;
@@ -114,25 +115,25 @@ template <typename T_container = std::vector<int>>
         }
 
         // Distance squared from origin
-        int dist2() const
+        constexpr int dist2() const
         {
             return x*x + y*y;
         }
 
         // compare for order.
-        bool operator <(const point& pt) const
+        constexpr bool operator <(const point& pt) const
         {
             return pt.dist2() > dist2();
         }
 
     };
 
-    bool operator==(const point &p1, const point& p2)
+    constexpr bool operator==(const point &p1, const point& p2)
     {
         return p1.x == p2.x && p1.y == p2.y;
     }
 
-    bool operator!=(const point &p1, const point& p2)
+    constexpr bool operator!=(const point &p1, const point& p2)
     {
         return p1.x != p2.x || p1.y != p2.y;
     }
@@ -151,10 +152,158 @@ template <typename T_container = std::vector<int>>
             << p.y;
     }
 
-    template <typename T> int sgn(T val)
+    template <typename T> constexpr int sgn(T val)
     {
         return (T(0) < val) - (val < T(0));
     }
+
+    template <typename T> constexpr T abs(T val)
+    {
+        return val < T(0) ? -val : val;
+    }
+
+    // ---------------------------------------------------------------------
+    // constexpr parsing helpers (C++20).
+    //
+    // These work on std::string_view and can run during compilation, so the
+    // examples can be verified with static_assert:
+    //
+    //    constexpr std::string_view example = R"(3 4
+    //    4 3)";
+    //    static_assert(solve_puzzle1(myutils::split_lines(example)) == 11);
+    //
+    // The views point into the original text, which must outlive them.
+    // ---------------------------------------------------------------------
+
+    // Split on sepValue. Empty fields are dropped unless keepEmpty.
+    constexpr std::vector<std::string_view>
+    split(std::string_view text, char sepValue, bool keepEmpty=false)
+    {
+        std::vector<std::string_view> fields;
+
+        std::string_view::size_type start = 0;
+
+        while(start <= text.size())
+        {
+            auto end = text.find(sepValue, start);
+            if(end == std::string_view::npos)
+                end = text.size();
+
+            std::string_view field = text.substr(start, end - start);
+
+            if(keepEmpty || !field.empty())
+                fields.push_back(field);
+
+            start = end + 1;
+        }
+
+        return fields;
+    }
+
+    // Split a multi-line text into lines, same as read_file(..., keepSpaces)
+    constexpr std::vector<std::string_view>
+    split_lines(std::string_view text, bool keepEmptyLines=false)
+    {
+        return split(text, '\n', keepEmptyLines);
+    }
+
+    constexpr bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    // Parse a signed integer at the start of text, skipping leading blanks.
+    // On return, text is advanced past the number.
+    template <typename T = long long>
+    constexpr T parse_int(std::string_view& text)
+    {
+        std::string_view::size_type i = 0;
+
+        while(i < text.size() && (text[i] == ' ' || text[i] == '\t'))
+            i++;
+
+        bool negative = false;
+        if(i < text.size() && (text[i] == '-' || text[i] == '+'))
+            negative = text[i++] == '-';
+
+        T value = 0;
+        while(i < text.size() && is_digit(text[i]))
+            value = value * 10 + (text[i++] - '0');
+
+        text.remove_prefix(i);
+
+        return negative ? -value : value;
+    }
+
+    // All the integers found in text, whatever separates them
+    template <typename T = long long>
+    constexpr std::vector<T> parse_ints(std::string_view text)
+    {
+        std::vector<T> values;
+
+        while(!text.empty())
+        {
+            bool signedStart =
+                (text[0] == '-' || text[0] == '+') && text.size() > 1 && is_digit(text[1]);
+
+            if(is_digit(text[0]) || signedStart)
+                values.push_back(parse_int<T>(text));
+            else
+                text.remove_prefix(1);
+        }
+
+        return values;
+    }
+
+    // Read-only view of a rectangular grid of characters, one line per row.
+    // The rows are referenced, not copied: they must outlive the view.
+    template <typename T_container = std::vector<std::string_view>>
+    class grid_view
+    {
+        const T_container& rows_;
+
+    public:
+        constexpr explicit grid_view(const T_container& rows) : rows_(rows) {}
+        explicit grid_view(const T_container&& rows) = delete;
+
+        constexpr int height() const { return rows_.size(); }
+        constexpr int width()  const { return rows_.empty() ? 0 : rows_[0].size(); }
+
+        constexpr bool in_bounds(int x, int y) const
+        {
+            return x >= 0 && y >= 0 && y < height() && x < width();
+        }
+
+        constexpr bool in_bounds(const point& p) const { return in_bounds(p.x, p.y); }
+
+        // Character at (x, y), or outside if out of bounds
+        constexpr char at(int x, int y, char outside='\0') const
+        {
+            return in_bounds(x, y) ? rows_[y][x] : outside;
+        }
+
+        constexpr char at(const point& p, char outside='\0') const { return at(p.x, p.y, outside); }
+
+        // Position of the first c, or (-1, -1)
+        constexpr point find(char c) const
+        {
+            for(int y=0; y<height(); y++)
+            {
+                auto x = std::string_view(rows_[y]).find(c);
+                if(x != std::string_view::npos)
+                    return point(x, y);
+            }
+            return point(-1, -1);
+        }
+
+        constexpr int count(char c) const
+        {
+            int n = 0;
+            for(int y=0; y<height(); y++)
+                n += std::count(rows_[y].begin(), rows_[y].end(), c);
+            return n;
+        }
+    };
 }
 
 // Specialized template
@@ -0,0 +1,85 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+#include <iostream>
+#include <vector>
+#include <string_view>
+#include "myutils.h"
+
+#ifdef AOC_EMBEDDED_INPUT
+#include "aoc_input.h"
+#endif
+
+using namespace std;
+
+// The solvers are constexpr: use the myutils parsing helpers
+// (split, parse_int, parse_ints, grid_view) instead of the streams.
+
+// Solve puzzle #1
+template <typename T>
+constexpr long solve_puzzle1(const T& data)
+{
+    return 42;
+}
+
+// Solve puzzle #2
+template <typename T>
+constexpr long solve_puzzle2(const T& data)
+{
+    return 42;
+}
+
+// The examples are verified during compilation
+constexpr std::string_view example = R"(1
+2)";
+
+static_assert(solve_puzzle1(myutils::split_lines(example)) == 42 && "Error verifying puzzle #1");
+static_assert(solve_puzzle2(myutils::split_lines(example)) == 42 && "Error verifying puzzle #2");
+
+int main(int argc, char *argv[])
+{
+#ifndef AOC_EMBEDDED_INPUT
+    // Need a command-line parameter for the input filename
+    if (argc != 2) {
+        cerr << "Error: missing input" << endl;
+        return EXIT_FAILURE;
+    }
+
+    string filename(argv[1]);
+
+    // This file needs to exist
+    if (! myutils::file_exists(filename))
+    {
+        cerr << "Error: nonexistent file: " << filename << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Reading the data
+    std::vector<string> data;
+    bool keepSpace = true;
+    bool keepEmptyLine = false;
+    bool debug = false;
+
+    myutils::read_file(data, filename, keepSpace, keepEmptyLine, debug);
+#endif
+
+    // --------- Puzzle #1 ---------
+#ifdef AOC_EMBEDDED_INPUT
+    // Solved during compilation
+    constexpr long answer1 = solve_puzzle1(myutils::split_lines(aoc_input));
+#else
+    long answer1 = solve_puzzle1(data);
+#endif
+    std::cout << "Answer for puzzle #1: "<< answer1 << std::endl;
+
+    // --------- Puzzle #2 ---------
+#ifdef AOC_EMBEDDED_INPUT
+    constexpr long answer2 = solve_puzzle2(myutils::split_lines(aoc_input));
+#else
+    long answer2 = solve_puzzle2(data);
+#endif
+    std::cout << "Answer for puzzle #2: "<< answer2 << std::endl;
+}
@@ -0,0 +1,119 @@
+#
+# Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+#
+# See the repository's LICENSE file for the full license details.
+#
+# Two-stage profile-guided optimization.
+#
+#   1) cmake -S . -B build-pgo -DAOC_PGO=GENERATE
+#      cmake --build build-pgo
+#      cmake --build build-pgo --target pgo-train
+#
+#   2) cmake -S . -B build -DAOC_PGO=USE -DAOC_PGO_DIR=<build-pgo>/pgo
+#      cmake --build build
+#
+# pgo-train runs every instrumented puzzle on the input.txt of its day
+# directory (see each day's "make getdata"), if any.  The repository ships no
+# input: the other puzzles are run on an empty input, which trains the
+# examples verified at the top of main() until the first check against the
+# actual answer fails.  AocPGODump.cpp, linked in this stage, writes the
+# profile of these aborted runs.  The USE stage refuses a directory without
+# profile data.
+#
+
+set(AOC_PGO "OFF" CACHE STRING "Profile-guided optimization stage: OFF, GENERATE or USE")
+set_property(CACHE AOC_PGO PROPERTY STRINGS OFF GENERATE USE)
+
+set(AOC_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Directory for the PGO profile data")
+
+if(NOT AOC_PGO MATCHES "^(OFF|GENERATE|USE)$")
+    message(FATAL_ERROR "AOC_PGO must be OFF, GENERATE or USE, not '${AOC_PGO}'")
+endif()
+
+# GCC names the profile files after the object file path:
+# -fprofile-prefix-path makes them independent of the build directory, so
+# that the USE stage finds the GENERATE stage data.
+set(_aoc_pgo_compile_options "")
+set(_aoc_pgo_link_options "")
+
+if(AOC_PGO STREQUAL "GENERATE")
+    file(MAKE_DIRECTORY "${AOC_PGO_DIR}")
+
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        set(_aoc_pgo_compile_options
+            "-fprofile-generate=${AOC_PGO_DIR}"
+            "-fprofile-prefix-path=${CMAKE_BINARY_DIR}"
+            "-fprofile-update=atomic")
+    else()
+        set(_aoc_pgo_compile_options "-fprofile-generate=${AOC_PGO_DIR}")
+    endif()
+    set(_aoc_pgo_link_options ${_aoc_pgo_compile_options})
+
+elseif(AOC_PGO STREQUAL "USE")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        file(GLOB_RECURSE _aoc_pgo_profiles "${AOC_PGO_DIR}/*.gcda")
+    else()
+        file(GLOB _aoc_pgo_profiles "${AOC_PGO_DIR}/merged.profdata")
+    endif()
+
+    if(NOT _aoc_pgo_profiles)
+        message(FATAL_ERROR "AOC_PGO=USE: no profile data in ${AOC_PGO_DIR}. Run the GENERATE stage and pgo-train first.")
+    endif()
+
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        set(_aoc_pgo_compile_options
+            "-fprofile-use=${AOC_PGO_DIR}"
+            "-fprofile-prefix-path=${CMAKE_BINARY_DIR}"
+            "-fprofile-partial-training"
+            "-Wno-missing-profile")
+    else()
+        # Clang wants a single merged file, see pgo-train
+        set(_aoc_pgo_compile_options
+            "-fprofile-use=${AOC_PGO_DIR}/merged.profdata"
+            "-Wno-profile-instr-unprofiled")
+    endif()
+    set(_aoc_pgo_link_options ${_aoc_pgo_compile_options})
+endif()
+
+function(aoc_apply_pgo target)
+    if(_aoc_pgo_compile_options)
+        target_compile_options(${target} PRIVATE ${_aoc_pgo_compile_options})
+        target_link_options(${target} PRIVATE ${_aoc_pgo_link_options})
+    endif()
+
+    if(AOC_PGO STREQUAL "GENERATE")
+        target_sources(${target} PRIVATE "${CMAKE_SOURCE_DIR}/cmake/AocPGODump.cpp")
+    endif()
+endfunction()
+
+# Training run over all the puzzles having some input data
+function(aoc_add_pgo_training_target)
+    if(NOT AOC_PGO STREQUAL "GENERATE")
+        return()
+    endif()
+
+    get_property(_targets GLOBAL PROPERTY AOC_PUZZLE_TARGETS)
+
+    set(_runs "")
+    foreach(_target IN LISTS _targets)
+        get_target_property(_sources ${_target} SOURCES)
+        list(GET _sources 0 _source)
+        get_filename_component(_dir "${_source}" DIRECTORY)
+        string(APPEND _runs "$<TARGET_FILE:${_target}>|${_dir}\n")
+    endforeach()
+
+    file(GENERATE OUTPUT "${CMAKE_BINARY_DIR}/pgo-train-$<CONFIG>.txt" CONTENT "${_runs}")
+
+    find_program(AOC_LLVM_PROFDATA llvm-profdata)
+
+    add_custom_target(pgo-train
+        COMMAND ${CMAKE_COMMAND}
+            -DRUN_LIST=${CMAKE_BINARY_DIR}/pgo-train-$<CONFIG>.txt
+            -DPGO_DIR=${AOC_PGO_DIR}
+            -DCOMPILER_ID=${CMAKE_CXX_COMPILER_ID}
+            -DLLVM_PROFDATA=${AOC_LLVM_PROFDATA}
+            -P ${CMAKE_SOURCE_DIR}/cmake/AocPGOTrain.cmake
+        DEPENDS ${_targets}
+        COMMENT "Training the instrumented puzzles"
+        VERBATIM)
+endfunction()
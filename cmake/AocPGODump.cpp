@@ -0,0 +1,42 @@
+//
+// Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+//
+// See the repository's LICENSE file for the full license details.
+//
+
+// Linked into the puzzles of the AOC_PGO=GENERATE stage only.
+//
+// Without its input.txt, pgo-train runs a puzzle on an empty input: the
+// examples verified at the top of main() run, then the first check against
+// the actual answer fails (or the solver trips on the missing data). The
+// profile is normally written at exit, which an abort skips: write it from
+// the signal handler, then let the signal terminate the process as usual.
+
+#include <csignal>
+#include <initializer_list>
+
+#if defined(__clang__)
+extern "C" int __llvm_profile_write_file(void);
+#define AOC_PGO_WRITE_PROFILE() __llvm_profile_write_file()
+#else
+extern "C" void __gcov_dump(void);
+#define AOC_PGO_WRITE_PROFILE() __gcov_dump()
+#endif
+
+namespace
+{
+    void write_profile_and_die(int sig)
+    {
+        AOC_PGO_WRITE_PROFILE();
+
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+
+    const bool installed = []
+    {
+        for(int sig : {SIGABRT, SIGSEGV, SIGFPE, SIGBUS})
+            std::signal(sig, write_profile_and_die);
+        return true;
+    }();
+}
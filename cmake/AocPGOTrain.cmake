@@ -0,0 +1,88 @@
+#
+# Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+#
+# See the repository's LICENSE file for the full license details.
+#
+# Script mode (cmake -P) driver for the pgo-train target.
+#
+# RUN_LIST: file with one "executable|day directory" per line
+# PGO_DIR: profile data directory
+#
+
+file(STRINGS "${RUN_LIST}" _runs)
+
+# Stand-in for the missing inputs
+set(_empty "${PGO_DIR}/empty-input.txt")
+file(WRITE "${_empty}" "")
+
+set(_withInput 0)
+set(_examplesOnly 0)
+set(_timedOut 0)
+
+foreach(_run IN LISTS _runs)
+    string(REPLACE "|" ";" _run "${_run}")
+    list(GET _run 0 _exe)
+    list(GET _run 1 _dir)
+
+    # Without input, only the examples run: they are quick, unless the
+    # solver loops on the empty data
+    if(EXISTS "${_dir}/input.txt")
+        set(_input input.txt)
+        set(_timeout 600)
+    else()
+        set(_input "${_empty}")
+        set(_timeout 60)
+    endif()
+
+    execute_process(
+        COMMAND "${_exe}" "${_input}"
+        WORKING_DIRECTORY "${_dir}"
+        RESULT_VARIABLE _result
+        OUTPUT_QUIET
+        ERROR_QUIET
+        TIMEOUT ${_timeout})
+
+    # A killed run writes no profile. Failures are expected on the empty
+    # input, and AocPGODump.cpp writes their profile.
+    if(_result MATCHES "timeout")
+        message(WARNING "Training run timed out: ${_exe}")
+        math(EXPR _timedOut "${_timedOut} + 1")
+    elseif(_input STREQUAL "input.txt")
+        if(NOT _result EQUAL 0)
+            message(WARNING "Training run failed (${_result}): ${_exe}")
+        endif()
+        math(EXPR _withInput "${_withInput} + 1")
+    else()
+        math(EXPR _examplesOnly "${_examplesOnly} + 1")
+    endif()
+endforeach()
+
+message(STATUS "PGO training: ${_withInput} puzzle(s) run on their input, "
+               "${_examplesOnly} on their examples only, ${_timedOut} timed out")
+
+if(COMPILER_ID STREQUAL "GNU")
+    file(GLOB_RECURSE _profiles "${PGO_DIR}/*.gcda")
+else()
+    file(GLOB _profiles "${PGO_DIR}/*.profraw")
+endif()
+
+if(NOT _profiles)
+    message(FATAL_ERROR "PGO training wrote no profile data in ${PGO_DIR}")
+endif()
+
+# Clang: merge the raw profiles into the single file used by the USE stage
+if(NOT COMPILER_ID STREQUAL "GNU")
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "llvm-profdata is needed to merge the Clang profiles")
+    endif()
+
+    file(GLOB _raw "${PGO_DIR}/*.profraw")
+    if(_raw)
+        execute_process(
+            COMMAND "${LLVM_PROFDATA}" merge -output=${PGO_DIR}/merged.profdata ${_raw}
+            RESULT_VARIABLE _result)
+        if(NOT _result EQUAL 0)
+            message(FATAL_ERROR "llvm-profdata merge failed")
+        endif()
+    endif()
+endif()
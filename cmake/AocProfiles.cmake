@@ -0,0 +1,67 @@
+#
+# Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+#
+# See the repository's LICENSE file for the full license details.
+#
+# Build profiles: Release, Fast, Debug and Sanitize.
+#
+
+set(_aoc_profiles Release Fast Debug Sanitize)
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+    set(CMAKE_BUILD_TYPE Release CACHE STRING "Build profile" FORCE)
+endif()
+
+if(CMAKE_BUILD_TYPE)
+    set_property(CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS ${_aoc_profiles})
+
+    if(NOT CMAKE_BUILD_TYPE IN_LIST _aoc_profiles)
+        message(FATAL_ERROR
+            "Unknown build profile '${CMAKE_BUILD_TYPE}'. "
+            "Choose one of: ${_aoc_profiles}")
+    endif()
+endif()
+
+option(AOC_NATIVE "Tune the Release profile for the build machine (-march=native)" ON)
+option(AOC_LTO "Use link-time optimization in the Release profile" ON)
+
+# No -DNDEBUG anywhere: the examples are checked with assert().
+string(REPLACE "-DNDEBUG" "" CMAKE_CXX_FLAGS_RELEASE "${CMAKE_CXX_FLAGS_RELEASE}")
+set(CMAKE_CXX_FLAGS_FAST "-O1" CACHE STRING "")
+set(CMAKE_CXX_FLAGS_SANITIZE
+    "-O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined -fno-sanitize-recover=undefined -D_GLIBCXX_ASSERTIONS"
+    CACHE STRING "")
+set(CMAKE_EXE_LINKER_FLAGS_FAST "" CACHE STRING "")
+set(CMAKE_EXE_LINKER_FLAGS_SANITIZE "-fsanitize=address,undefined" CACHE STRING "")
+
+mark_as_advanced(
+    CMAKE_CXX_FLAGS_FAST
+    CMAKE_CXX_FLAGS_SANITIZE
+    CMAKE_EXE_LINKER_FLAGS_FAST
+    CMAKE_EXE_LINKER_FLAGS_SANITIZE)
+
+# Release only: native tuning and LTO
+if(AOC_NATIVE)
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-march=native" AOC_HAS_MARCH_NATIVE)
+endif()
+
+set(AOC_IPO_SUPPORTED FALSE)
+if(AOC_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT AOC_IPO_SUPPORTED OUTPUT _aoc_ipo_msg LANGUAGES CXX)
+    if(NOT AOC_IPO_SUPPORTED)
+        message(STATUS "LTO not supported: ${_aoc_ipo_msg}")
+    endif()
+endif()
+
+# Apply the per-profile options to a puzzle target
+function(aoc_apply_profile target)
+    if(AOC_HAS_MARCH_NATIVE)
+        target_compile_options(${target} PRIVATE $<$<CONFIG:Release>:-march=native>)
+    endif()
+
+    if(AOC_IPO_SUPPORTED)
+        set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION_RELEASE TRUE)
+    endif()
+endfunction()
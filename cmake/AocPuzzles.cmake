@@ -0,0 +1,120 @@
+#
+# Copyright (C) Martin Beaudoin. 2024. All Rights Reserved.
+#
+# See the repository's LICENSE file for the full license details.
+#
+# Puzzle discovery.
+#
+# Every YEAR/day_NN/<name>.cpp becomes the executable <build>/YEAR/day_NN/<name>,
+# the same name the day's Makefile produces.  Target names are
+# aocYEAR_dayNN_<name> (ie: aoc2019_day04_puzzleSTL).
+#
+# External libraries are picked up from the #include lines of each source.
+#
+# With AOC_EMBED_INPUT, the day's input.txt is embedded as a string literal in
+# the generated aoc_input.h, for the puzzles supporting AOC_EMBEDDED_INPUT
+# (their answers are then computed during compilation).
+#
+
+option(AOC_EMBED_INPUT "Embed input.txt in the puzzles supporting it, and solve them at compile time" OFF)
+
+find_package(Threads REQUIRED)
+
+# All puzzle targets, used by the PGO training target
+set_property(GLOBAL PROPERTY AOC_PUZZLE_TARGETS "")
+
+function(aoc_link_dependencies target source)
+    file(STRINGS "${source}" _includes REGEX "^[ \t]*#[ \t]*include")
+
+    # openssl/*.h, or the headers wrapping it (myhashsearch_openssl.h)
+    if(_includes MATCHES "openssl")
+        find_package(OpenSSL REQUIRED COMPONENTS Crypto)
+        target_link_libraries(${target} PRIVATE OpenSSL::Crypto)
+    endif()
+
+    if(_includes MATCHES "n?curses\\.h")
+        set(CURSES_NEED_NCURSES TRUE)
+        find_package(Curses REQUIRED)
+        target_include_directories(${target} PRIVATE ${CURSES_INCLUDE_DIRS})
+        target_link_libraries(${target} PRIVATE ${CURSES_LIBRARIES})
+    endif()
+
+    if(_includes MATCHES "boost/")
+        find_package(Boost REQUIRED)
+        target_link_libraries(${target} PRIVATE Boost::boost)
+    endif()
+
+    target_link_libraries(${target} PRIVATE Threads::Threads)
+endfunction()
+
+function(aoc_embed_input target source)
+    file(STRINGS "${source}" _embedded REGEX "AOC_EMBEDDED_INPUT" LIMIT_COUNT 1)
+    get_filename_component(_dir "${source}" DIRECTORY)
+
+    if(NOT _embedded OR NOT EXISTS "${_dir}/input.txt")
+        return()
+    endif()
+
+    get_target_property(_out_dir ${target} RUNTIME_OUTPUT_DIRECTORY)
+    set(_header "${_out_dir}/aoc_input.h")
+
+    file(READ "${_dir}/input.txt" _input)
+    file(WRITE "${_header}.tmp"
+        "// Generated from ${_dir}/input.txt\n"
+        "#include <string_view>\n"
+        "constexpr std::string_view aoc_input = R\"aoc_input(${_input})aoc_input\";\n")
+    configure_file("${_header}.tmp" "${_header}" COPYONLY)
+
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${_dir}/input.txt")
+
+    target_include_directories(${target} PRIVATE "${_out_dir}")
+    target_compile_definitions(${target} PRIVATE AOC_EMBEDDED_INPUT)
+
+    # Whole inputs take more steps than the default compiler limits
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        target_compile_options(${target} PRIVATE -fconstexpr-ops-limit=2147483647 -fconstexpr-loop-limit=16777216)
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        target_compile_options(${target} PRIVATE -fconstexpr-steps=2147483647)
+    endif()
+endfunction()
+
+function(aoc_add_puzzle year day source)
+    get_filename_component(_name "${source}" NAME_WE)
+    string(REPLACE "_" "" _day_id "${day}")
+    set(_target "aoc${year}_${_day_id}_${_name}")
+
+    add_executable(${_target} "${source}")
+
+    set_target_properties(${_target} PROPERTIES
+        OUTPUT_NAME "${_name}"
+        RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/${year}/${day}")
+
+    # 2018 includes "include/myutils.h", the other years "myutils.h"
+    target_include_directories(${_target} PRIVATE
+        "${CMAKE_SOURCE_DIR}/${year}"
+        "${CMAKE_SOURCE_DIR}/${year}/include")
+
+    aoc_link_dependencies(${_target} "${source}")
+
+    if(AOC_EMBED_INPUT)
+        aoc_embed_input(${_target} "${source}")
+    endif()
+
+    aoc_apply_profile(${_target})
+    aoc_apply_pgo(${_target})
+
+    set_property(GLOBAL APPEND PROPERTY AOC_PUZZLE_TARGETS ${_target})
+endfunction()
+
+function(aoc_add_year year)
+    file(GLOB _sources CONFIGURE_DEPENDS
+        "${CMAKE_SOURCE_DIR}/${year}/day_[0-9][0-9]/*.cpp")
+
+    list(SORT _sources)
+
+    foreach(_source IN LISTS _sources)
+        get_filename_component(_dir "${_source}" DIRECTORY)
+        get_filename_component(_day "${_dir}" NAME)
+        aoc_add_puzzle(${year} ${_day} "${_source}")
+    endforeach()
+endfunction()